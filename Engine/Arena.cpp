@@ -0,0 +1,687 @@
+#include "Arena.h"
+#include "Zobrist.h"
+#include <algorithm>
+#include <assert.h>
+#include <climits>
+#include <cmath>
+#include <cstdlib>
+
+Arena::Arena(const GameVariables& gVar, const Topology& topology, int nSnakes, GameState& state, MemoryPool& memory)
+	:
+	topology(topology),
+	nSnakes(nSnakes),
+	maxLength(gVar.maxSnakelength > 0 ? std::max(2, gVar.maxSnakelength) : INT_MAX),
+	initialLength(std::max(1, gVar.initialSnakelength)),
+	initialPeriod(gVar.initialSpeed),
+	speedupRate(gVar.speedupRate),
+	foodLifetime(TicksOf(gVar.foodLifetime)),
+	barrierLifetime(TicksOf(gVar.barrierLifetime)),
+	waveInterval(TicksOf(gVar.waveInterval)),
+	waveSize(gVar.waveSize),
+	nItemSlots(ItemSlotsOf(gVar)),
+	waveEvent(nSnakes + nItemSlots),
+	firstWanderer(nSnakes),
+	velocity(state.New<Location>(nSnakes)),
+	jumpMultiplier(state.New<int>(nSnakes)),
+	movePeriod(state.New<float>(nSnakes)),
+	score(state.New<int>(nSnakes)),
+	pendingGrowth(state.New<int>(nSnakes)),
+	crashed(state.New<unsigned char>(nSnakes)),
+	pHash(state.New<uint64_t>(1)),
+	pClock(state.New<unsigned long long>(1)),
+	items(state.New<TimedItem>(nItemSlots)),
+	freeItems(state.New<int>(nItemSlots)),
+	pFreeItemCount(state.New<int>(1)),
+	bodies(state, nSnakes, topology, memory, gVar.rewindBudget > 0),
+	wheel(state, waveEvent + 1),
+	due(PoolAllocator<int>(memory)),
+	movers(PoolAllocator<int>(memory)),
+	target(nSnakes, Cell(), PoolAllocator<Cell>(memory)),
+	keepsTail(nSnakes, 0, PoolAllocator<unsigned char>(memory)),
+	vacated(nSnakes, 0, PoolAllocator<unsigned char>(memory)),
+	claim(PoolAllocator<CellMap>(memory)),
+	headAt(PoolAllocator<CellMap>(memory)),
+	restored(PoolAllocator<Location>(memory)),
+	isMover(nSnakes, 0, PoolAllocator<unsigned char>(memory)),
+	isLocal(nSnakes, 0, PoolAllocator<unsigned char>(memory)),
+	bandOfRow(PoolAllocator<int>(memory)),
+	regionSnakes(PoolAllocator<PoolVector<int>>(memory)),
+	pool(std::max(1, gVar.numThreads)),
+	tickFn(PickTick(gVar, topology))
+{
+	stateBegin = state.OffsetOf(velocity);
+	stateEnd = state.GetUsed();
+	std::fill_n(velocity, nSnakes, Location(1, 0));
+	std::fill_n(jumpMultiplier, nSnakes, 1);
+	std::fill_n(movePeriod, nSnakes, initialPeriod);
+	for (int k = 0; k < nItemSlots; k++)
+	{
+		freeItems[k] = nItemSlots - 1 - k;
+	}
+	*pFreeItemCount = nItemSlots;
+	if (waveInterval > 0)
+	{
+		wheel.Schedule(waveEvent, waveInterval);
+	}
+	// a few bands per thread so uneven snake density still balances
+	nRegions = std::max(1, std::min(gVar.boardSizeY, 4 * pool.GetThreadCount()));
+	bandHeight = (gVar.boardSizeY + nRegions - 1) / nRegions;
+	nRegions = (gVar.boardSizeY + bandHeight - 1) / bandHeight;
+	bandOfRow.resize(gVar.boardSizeY);
+	for (int y = 0; y < gVar.boardSizeY; y++)
+	{
+		bandOfRow[y] = y / bandHeight;
+	}
+	// the tick allocates nothing once these hold the busiest band; an even
+	// spread of heads fits from the start
+	regionSnakes.reserve(nRegions);
+	claim.reserve(nRegions);
+	headAt.reserve(nRegions);
+	for (int r = 0; r < nRegions; r++)
+	{
+		regionSnakes.emplace_back(PoolAllocator<int>(memory));
+		regionSnakes[r].reserve(nSnakes);
+		claim.emplace_back(memory);
+		claim[r].Reserve(2 * size_t(nSnakes) / nRegions + 1);
+		headAt.emplace_back(memory);
+		headAt[r].Reserve(2 * size_t(nSnakes) / nRegions + 1);
+	}
+	due.reserve(size_t(waveEvent) + 1);
+	movers.reserve(nSnakes);
+	restored.reserve(nSnakes);
+}
+
+size_t Arena::StateBytes(const GameVariables& gVar, int nSnakes)
+{
+	// snakes never share a cell, so the board bounds their total length
+	long long maxLinks = (long long)gVar.boardSizeX * gVar.boardSizeY;
+	if (gVar.maxSnakelength > 0)
+	{
+		maxLinks = std::min(maxLinks, (long long)nSnakes * std::max(2, gVar.maxSnakelength));
+	}
+	const int nItemSlots = ItemSlotsOf(gVar);
+	return GameState::Bound<Location>(nSnakes) + 3 * GameState::Bound<int>(nSnakes)
+		+ GameState::Bound<float>(nSnakes) + GameState::Bound<unsigned char>(nSnakes) + GameState::Bound<uint64_t>(1)
+		+ GameState::Bound<unsigned long long>(1) + GameState::Bound<TimedItem>(nItemSlots)
+		+ GameState::Bound<int>(nItemSlots) + GameState::Bound<int>(1)
+		+ SnakeBodies::StateBytes(nSnakes, maxLinks) + TimingWheel::StateBytes(nSnakes + nItemSlots + 1);
+}
+
+int Arena::ItemSlotsOf(const GameVariables& gVar)
+{
+	return gVar.foodLifetime > 0.0f || gVar.barrierLifetime > 0.0f ? std::max(0, gVar.timedItems) : 0;
+}
+
+uint64_t Arena::TicksOf(float seconds)
+{
+	return seconds > 0.0f ? uint64_t(std::llround(double(seconds) * ticksPerSecond)) : 0;
+}
+
+uint64_t Arena::PeriodOf(int id) const
+{
+	return std::max(uint64_t(1), TicksOf(movePeriod[id]));
+}
+
+int Arena::GetCount() const
+{
+	return nSnakes;
+}
+
+void Arena::Spawn(int id, const Location& startloc, Board& brd)
+{
+	Clear(id, brd);
+	assert(brd.GetCellContent(startloc) == Board::contentType::empty);
+	brd.SetCellContent(startloc, Board::contentType::snake);
+	bodies.Start(id, startloc);
+	brd.GetJournal().Head(id, startloc);
+	// the rest of the body unfolds from the start cell over the first moves
+	pendingGrowth[id] = std::min(initialLength, maxLength) - 1;
+	velocity[id] = Location(1, 0);
+	*pHash ^= SnakeKey(id);
+	jumpMultiplier[id] = 1;
+	movePeriod[id] = initialPeriod;
+	score[id] = 0;
+	crashed[id] = 0;
+	wheel.Schedule(id, wheel.GetNow() + PeriodOf(id));
+}
+
+bool Arena::SpawnAnywhere(int id, Board& brd, Rng& rng)
+{
+	Clear(id, brd);
+	// the spawn cells first; when they stay taken, any free cell
+	Location loc = brd.DrawSpawnCell(rng);
+	for (int k = 1; k < spawnDraws && brd.GetCellContent(loc) != Board::contentType::empty; k++)
+	{
+		loc = brd.DrawSpawnCell(rng);
+	}
+	if (brd.GetCellContent(loc) != Board::contentType::empty && !brd.DrawFreeCell(rng, loc))
+	{
+		// off the board and crashed, so the game tries again
+		crashed[id] = 1;
+		return false;
+	}
+	Spawn(id, loc, brd);
+	return true;
+}
+
+void Arena::Reset(int id, Board& brd)
+{
+	while (bodies.GetLength(id) > 2)
+	{
+		brd.SetCellContent(bodies.GetTail(id), Board::contentType::empty);
+		brd.GetJournal().Tail(id, bodies.GetTail(id));
+		bodies.PopTail(id);
+	}
+	pendingGrowth[id] = 0;
+	jumpMultiplier[id] = 1;
+	movePeriod[id] = initialPeriod;
+	crashed[id] = 0;
+	if (bodies.GetLength(id) > 0)
+	{
+		wheel.Schedule(id, wheel.GetNow() + PeriodOf(id));
+	}
+}
+
+void Arena::SpawnItems(Board::contentType type, int n, Board& brd, Rng& rng)
+{
+	const uint64_t lifetime = type == Board::contentType::food ? foodLifetime
+		: type == Board::contentType::barrier ? barrierLifetime : 0;
+	for (int k = 0; k < n; k++)
+	{
+		Location loc;
+		if (!brd.Spawn(type, rng, loc))
+		{
+			return;
+		}
+		// with no slot left the item simply stays
+		if (lifetime > 0 && *pFreeItemCount > 0)
+		{
+			const int slot = freeItems[--*pFreeItemCount];
+			items[slot] = { loc, int(type) };
+			wheel.Schedule(nSnakes + slot, wheel.GetNow() + lifetime);
+		}
+	}
+}
+
+void Arena::Expire(int slot, Board& brd, Rng& rng)
+{
+	const TimedItem item = items[slot];
+	freeItems[(*pFreeItemCount)++] = slot;
+	// eaten food is gone already, and a snake may be sitting on the cell
+	if (int(brd.GetCellContent(item.cell)) == item.content)
+	{
+		brd.SetCellContent(item.cell, Board::contentType::empty);
+		// food moves elsewhere rather than running out
+		if (item.content == Board::contentType::food)
+		{
+			SpawnItems(Board::contentType::food, 1, brd, rng);
+		}
+	}
+}
+
+void Arena::Tick(float dt, Board& brd, Rng& rng)
+{
+	(this->*tickFn)(dt, brd, rng);
+}
+
+Arena::TickFn Arena::PickTick(const GameVariables& gVar, const Topology& topology)
+{
+	// the tournament sizes get their own copy of the tick
+	if (gVar.specialisedBoards)
+	{
+		if (Pow2Torus<6>::Fits(topology)) { return PickRules<Pow2Torus<6>>(gVar); }
+		if (Pow2Torus<7>::Fits(topology)) { return PickRules<Pow2Torus<7>>(gVar); }
+		if (Pow2Torus<8>::Fits(topology)) { return PickRules<Pow2Torus<8>>(gVar); }
+		if (Pow2Torus<9>::Fits(topology)) { return PickRules<Pow2Torus<9>>(gVar); }
+		if (Pow2Torus<10>::Fits(topology)) { return PickRules<Pow2Torus<10>>(gVar); }
+	}
+	return PickRules<AnyShape>(gVar);
+}
+
+template<class Shape>
+Arena::TickFn Arena::PickRules(const GameVariables& gVar)
+{
+	// one tick per rule set, indexed by the data.txt switches
+	static const TickFn registry[] = {
+		&Arena::TickWith<RuleSet<Shape, false, false, false>>,
+		&Arena::TickWith<RuleSet<Shape, true, false, false>>,
+		&Arena::TickWith<RuleSet<Shape, false, true, false>>,
+		&Arena::TickWith<RuleSet<Shape, true, true, false>>,
+		&Arena::TickWith<RuleSet<Shape, false, false, true>>,
+		&Arena::TickWith<RuleSet<Shape, true, false, true>>,
+		&Arena::TickWith<RuleSet<Shape, false, true, true>>,
+		&Arena::TickWith<RuleSet<Shape, true, true, true>>
+	};
+	return registry[(gVar.poisonSpeedup ? 1 : 0) | (gVar.barrierOnEat ? 2 : 0) | (gVar.jumps ? 4 : 0)];
+}
+
+template<class Rules>
+void Arena::TickWith(float dt, Board& brd, Rng& rng)
+{
+	typedef typename Rules::Shape Shape;
+
+	// the clock moves on and whatever came due fires, in (time, id) order
+	*pClock += (unsigned long long)std::llround(double(dt) * 1e6);
+	due.clear();
+	wheel.Advance(*pClock * uint64_t(ticksPerSecond) / 1000000, due);
+	movers.clear();
+	for (int e : due)
+	{
+		if (e < nSnakes)
+		{
+			movers.push_back(e);
+		}
+		else if (e == waveEvent)
+		{
+			SpawnItems(Board::contentType::food, waveSize, brd, rng);
+			wheel.Schedule(waveEvent, wheel.GetTime(waveEvent) + waveInterval);
+		}
+		else
+		{
+			Expire(e - nSnakes, brd, rng);
+		}
+	}
+	// snakes due this tick, in id order from here on
+	if (!std::is_sorted(movers.begin(), movers.end()))
+	{
+		std::sort(movers.begin(), movers.end());
+	}
+	// wanderers about to move may turn, drawing in id order like the rest
+	for (int id : movers)
+	{
+		if (id >= firstWanderer && !crashed[id] && bodies.GetLength(id) > 0)
+		{
+			const int turn = int(rng.Below(256));
+			const Location v = velocity[id];
+			if (turn == 0)
+			{
+				SetSnakeVelocity(id, { v.y, -v.x });
+			}
+			else if (turn == 1)
+			{
+				SetSnakeVelocity(id, { -v.y, v.x });
+			}
+		}
+	}
+
+	// bucket them by the band of rows their head is in
+	for (int r = 0; r < nRegions; r++)
+	{
+		regionSnakes[r].clear();
+		claim[r].Clear();
+		headAt[r].Clear();
+	}
+	for (int id : movers)
+	{
+		isMover[id] = 0;
+		if (!crashed[id] && bodies.GetLength(id) > 0)
+		{
+			regionSnakes[RegionOf(bodies.GetHead(id).y)].push_back(id);
+		}
+	}
+
+	// Per band, in parallel: targets, and head-on / swap conflicts
+	// between heads that stay inside the band. A band only writes claim and
+	// headAt maps and the state of snakes whose head it contains.
+	auto stepRegion = [&](int r)
+	{
+		for (int id : regionSnakes[r])
+		{
+			if (PlanMove<Rules>(id, brd))
+			{
+				isMover[id] = 1;
+				isLocal[id] = RegionOf(target[id].Y()) == r;
+				headAt[r][bodies.GetHead(id)] = id;
+			}
+		}
+		for (int id : regionSnakes[r])
+		{
+			if (isMover[id] && isLocal[id])
+			{
+				ClaimTarget(id);
+			}
+		}
+		for (int id : regionSnakes[r])
+		{
+			if (isMover[id] && isLocal[id])
+			{
+				CheckSwap(id);
+			}
+		}
+	};
+	pool.ParallelFor(nRegions, stepRegion);
+
+	// From here on everything runs in snake id order, so the outcome (and the
+	// rng stream) is the same for any thread count. Heads leaving their band
+	// are checked against the claims the bands made.
+	size_t nMovers = 0;
+	for (int id : movers)
+	{
+		if (isMover[id])
+		{
+			movers[nMovers++] = id;
+		}
+	}
+	movers.resize(nMovers);
+	for (int id : movers)
+	{
+		if (!isLocal[id])
+		{
+			ClaimTarget(id);
+		}
+	}
+	for (int id : movers)
+	{
+		if (!isLocal[id])
+		{
+			CheckSwap(id);
+		}
+	}
+
+	// tails leave before heads arrive, so following a tail is allowed
+	for (int id : movers)
+	{
+		if (!crashed[id] && !keepsTail[id])
+		{
+			brd.SetCellContent(bodies.GetTail(id), Board::contentType::empty);
+			vacated[id] = 1;
+		}
+	}
+
+	// heads running into barriers or bodies. A crashed snake stays where it is,
+	// so its tail comes back and may block another head in turn.
+	restored.clear();
+	auto crashMover = [&](int id)
+	{
+		Crash(id);
+		if (vacated[id])
+		{
+			const Location& tail = bodies.GetTail(id);
+			brd.SetCellContent(tail, Board::contentType::snake);
+			vacated[id] = 0;
+			restored.push_back(tail);
+		}
+	};
+	for (int id : movers)
+	{
+		if (!crashed[id])
+		{
+			const Board::contentType content = brd.GetCellContent(target[id].ToLocation());
+			if (content == Board::contentType::barrier || content == Board::contentType::snake)
+			{
+				crashMover(id);
+			}
+		}
+		while (!restored.empty())
+		{
+			const Location& tail = restored.back();
+			const int other = claim[RegionOf(tail.y)].Find(tail);
+			restored.pop_back();
+			if (other != CellMap::none && !crashed[other])
+			{
+				crashMover(other);
+			}
+		}
+	}
+
+	// survivors move in
+	ChangeJournal& journal = brd.GetJournal();
+	int nEaten = 0;
+	for (int id : movers)
+	{
+		vacated[id] = 0;
+		if (crashed[id])
+		{
+			continue;
+		}
+		const Location new_loc = target[id].ToLocation();
+		switch (brd.GetCellContent(new_loc))
+		{
+		case Board::contentType::food:
+			score[id]++;
+			pendingGrowth[id] += growth;
+			nEaten++;
+			break;
+		case Board::contentType::poison:
+			if (Rules::poisonSpeedup)
+			{
+				movePeriod[id] /= speedupRate;
+			}
+			break;
+		default:
+			break;
+		}
+		brd.SetCellContent(new_loc, Board::contentType::snake);
+		*pHash ^= SnakeKey(id);
+		bodies.PushHead<Shape>(id, Topology::DirOf(velocity[id]), StrideOf<Rules>(id));
+		*pHash ^= SnakeKey(id);
+		journal.Head(id, new_loc);
+		if (keepsTail[id])
+		{
+			pendingGrowth[id] = std::max(0, pendingGrowth[id] - 1);
+		}
+		else
+		{
+			journal.Tail(id, bodies.GetTail(id));
+			bodies.PopTail<Shape>(id);
+		}
+		jumpMultiplier[id] = 1;
+	}
+
+	// every food eaten brings a new food and a new barrier
+	SpawnItems(Board::contentType::food, nEaten, brd, rng);
+	if (Rules::barrierOnEat)
+	{
+		SpawnItems(Board::contentType::barrier, nEaten, brd, rng);
+	}
+
+	// the next move of every snake still alive, a period after this one but
+	// no earlier than the next tick
+	for (int id : due)
+	{
+		if (id < nSnakes && !crashed[id] && bodies.GetLength(id) > 0)
+		{
+			wheel.Schedule(id, std::max(wheel.GetTime(id) + PeriodOf(id), wheel.GetNow()));
+		}
+	}
+}
+
+template<class Rules>
+bool Arena::PlanMove(int id, Board& brd)
+{
+	if (!IsMoving(id))
+	{
+		jumpMultiplier[id] = 1;
+		return false;
+	}
+	Location new_loc;
+	if (!GetNextHeadLocation<Rules>(id, new_loc))
+	{
+		// into a wall; only this snake's state is touched, as planning requires
+		Crash(id);
+		return false;
+	}
+	target[id] = new_loc;
+	keepsTail[id] = (pendingGrowth[id] > 0 || brd.GetCellContent(new_loc) == Board::contentType::food)
+		&& bodies.GetLength(id) < maxLength;
+	return true;
+}
+
+void Arena::ClaimTarget(int id)
+{
+	// head-on: more than one head entering the same cell
+	int& c = claim[RegionOf(target[id].Y())][target[id]];
+	if (c == CellMap::none)
+	{
+		c = id;
+	}
+	else
+	{
+		Crash(c);
+		Crash(id);
+	}
+}
+
+void Arena::CheckSwap(int id)
+{
+	// swap: two heads trading cells, which no shared target or body cell reveals
+	// when both snakes are a single segment long
+	const int other = headAt[RegionOf(target[id].Y())].Find(target[id]);
+	if (other != CellMap::none && other != id && target[other] == Cell(bodies.GetHead(id)))
+	{
+		Crash(id);
+		Crash(other);
+	}
+}
+
+int Arena::RegionOf(int y) const
+{
+	return bandOfRow[y];
+}
+
+void Arena::Draw(Board& brd) const
+{
+	for (int id = 0; id < nSnakes; id++)
+	{
+		if (bodies.GetLength(id) > 0)
+		{
+			bodies.ForEach(id, [&](int k, const Location& loc) { brd.DrawCell(loc, k == 0 ? headColor : SkinColor(id, k)); });
+		}
+	}
+}
+
+void Arena::SetSnakeVelocity(int id, const Location& new_velocity)
+{
+	// no turning back into the neck, which may be across an edge or a portal;
+	// stopping is always allowed
+	Location next;
+	if (bodies.GetLength(id) <= 1 || new_velocity == Location(0, 0)
+		|| !topology.Advance(bodies.GetHead(id), Topology::DirOf(new_velocity), 1, next)
+		|| bodies.GetNeck(id) != next)
+	{
+		*pHash ^= SnakeKey(id);
+		velocity[id] = new_velocity;
+		*pHash ^= SnakeKey(id);
+	}
+}
+
+void Arena::SetWanderers(int firstId)
+{
+	firstWanderer = std::max(0, firstId);
+}
+
+Location Arena::GetSnakeVelocity(int id) const
+{
+	return velocity[id];
+}
+
+void Arena::JumpOn(int id)
+{
+	jumpMultiplier[id] = jumpSize + 1;
+}
+
+void Arena::ScaleMovePeriod(int id, float factor)
+{
+	movePeriod[id] *= factor;
+}
+
+bool Arena::IsCrashed(int id) const
+{
+	return crashed[id] != 0;
+}
+
+bool Arena::IsMoving(int id) const
+{
+	return (abs(velocity[id].x) + abs(velocity[id].y)) > 0;
+}
+
+int Arena::GetScore(int id) const
+{
+	return score[id];
+}
+
+int Arena::GetLength(int id) const
+{
+	return bodies.GetLength(id);
+}
+
+uint64_t Arena::GetHash() const
+{
+	return *pHash;
+}
+
+uint64_t Arena::ComputeHash() const
+{
+	uint64_t hash = 0;
+	for (int id = 0; id < nSnakes; id++)
+	{
+		hash ^= SnakeKey(id);
+	}
+	return hash;
+}
+
+bool Arena::IsIntact() const
+{
+	if (*pFreeItemCount < 0 || *pFreeItemCount > nItemSlots)
+	{
+		return false;
+	}
+	for (int i = 0; i < *pFreeItemCount; i++)
+	{
+		if (freeItems[i] < 0 || freeItems[i] >= nItemSlots)
+		{
+			return false;
+		}
+	}
+	return bodies.IsIntact() && wheel.IsIntact();
+}
+
+void Arena::AddTickWrites(const ChangeJournal& journal, TickWrites& writes)
+{
+	writes.Add(stateBegin, stateEnd - stateBegin);
+	bodies.AddTickWrites(journal, writes);
+}
+
+Location Arena::GetCurrentHeadLocation(int id) const
+{
+	return bodies.GetHead(id);
+}
+
+template<class Rules>
+bool Arena::GetNextHeadLocation(int id, Location& new_loc) const
+{
+	return Rules::Shape::Advance(topology, bodies.GetHead(id), Topology::DirOf(velocity[id]), StrideOf<Rules>(id), new_loc);
+}
+
+void Arena::Clear(int id, Board& brd)
+{
+	if (bodies.GetLength(id) > 0)
+	{
+		bodies.ForEach(id, [&](int, const Location& loc) { brd.SetCellContent(loc, Board::contentType::empty); });
+		brd.GetJournal().Gone(id);
+	}
+	*pHash ^= SnakeKey(id);
+	bodies.Clear(id);
+	wheel.Cancel(id);
+}
+
+uint64_t Arena::SnakeKey(int id) const
+{
+	return bodies.GetLength(id) > 0 ? Zobrist::SnakeKey(id, bodies.GetHead(id), velocity[id]) : 0;
+}
+
+void Arena::Crash(int id)
+{
+	crashed[id] = 1;
+	score[id] = 0;
+}
+
+Color Arena::SkinColor(int id, int k)
+{
+	// a hash of (snake, segment) in place of a stored colour per segment
+	uint32_t h = uint32_t(id) * 0x9E3779B1u ^ uint32_t(k) * 0x85EBCA77u;
+	h ^= h >> 15;
+	h *= 0xC2B2AE3Du;
+	h ^= h >> 13;
+	return Color(10, static_cast<unsigned char>(100 + h % 156), 10);
+}
@@ -0,0 +1,172 @@
+#pragma once
+#include "Location.h"
+#include "Board.h"
+#include "CellMap.h"
+#include "Colors.h"
+#include "GameVariables.h"
+#include "SnakeBodies.h"
+#include "GameState.h"
+#include "MemoryPool.h"
+#include "ThreadPool.h"
+#include "Topology.h"
+#include "TimingWheel.h"
+#include "RuleSet.h"
+#include "Rng.h"
+#include <vector>
+
+// All snakes of a game, stored as structure-of-arrays indexed by snake id.
+// Bodies are direction-encoded chains (SnakeBodies), so a move is a head push
+// plus a tail pop whatever the length. Which cells are
+// covered by snakes is kept on the Board (contentType::snake), which gives
+// O(1) collision tests and lets Board::Spawn avoid every snake.
+// Snake moves, item expiry and spawn waves are events on a TimingWheel in
+// milliseconds, so a tick only touches the snakes whose move came due.
+class Arena
+{
+public:
+	// per-snake data and bodies live in state, tick scratch in memory
+	Arena(const GameVariables& gVar, const Topology& topology, int nSnakes, GameState& state, MemoryPool& memory);
+	static size_t StateBytes(const GameVariables& gVar, int nSnakes);
+	int GetCount() const;
+	void Spawn(int id, const Location& startloc, Board& brd);
+	// on a free spawn cell, else on any free cell; with none the snake is left
+	// off the board, crashed, and false comes back
+	bool SpawnAnywhere(int id, Board& brd, Rng& rng);
+	void Reset(int id, Board& brd);
+	// n items on free cells, food and barriers expiring after [Food Lifetime]
+	// and [Barrier Lifetime] while [Timed Items] has room to track them
+	void SpawnItems(Board::contentType type, int n, Board& brd, Rng& rng);
+	// Moves the clock on by dt and advances every snake whose move came due,
+	// once at most however long dt is. All heads are resolved
+	// simultaneously: two heads entering the same cell or swapping cells crash,
+	// a head may enter a cell another tail leaves in the same tick, a head
+	// running off a walled board crashes.
+	// Planning runs in parallel over bands of board rows ([Threads]); the
+	// result does not depend on the thread count. The tick is compiled per
+	// RuleSet (board shape plus optional rules) and picked from the config;
+	// power-of-two torus boards get a copy specialised on their size.
+	void Tick(float dt, Board& brd, Rng& rng);
+	void Draw(Board& brd) const;
+	// ignored if it would turn the head back into the neck
+	void SetSnakeVelocity(int id, const Location& new_velocity);
+	// snakes from id on (drones) wander: before each of their moves a quarter
+	// turn left or right now and then, so how they steer follows moves, not frames
+	void SetWanderers(int firstId);
+	Location GetSnakeVelocity(int id) const;
+	void JumpOn(int id);
+	void ScaleMovePeriod(int id, float factor);
+	bool IsCrashed(int id) const;
+	bool IsMoving(int id) const;
+	int GetScore(int id) const;
+	int GetLength(int id) const;
+	Location GetCurrentHeadLocation(int id) const;
+	// Zobrist hash of every snake's id, head and velocity, kept up to date;
+	// with Board::GetHash it identifies a position (timers and scores aside)
+	uint64_t GetHash() const;
+	uint64_t ComputeHash() const;
+	// whether bodies, schedule and item slots only refer to what exists, for a
+	// state read from a file
+	bool IsIntact() const;
+	// what the tick journaled in journal may have written: the per-snake
+	// fields (scores, move periods, ...), item slots and schedule whole, the
+	// body blocks heads and tails touched and those freed
+	void AddTickWrites(const ChangeJournal& journal, TickWrites& writes);
+
+private:
+	typedef void (Arena::*TickFn)(float dt, Board& brd, Rng& rng);
+	static TickFn PickTick(const GameVariables& gVar, const Topology& topology);
+	template<class Shape>
+	static TickFn PickRules(const GameVariables& gVar);
+	template<class Rules>
+	void TickWith(float dt, Board& brd, Rng& rng);
+	template<class Rules>
+	int StrideOf(int id) const
+	{
+		return Rules::jumps ? jumpMultiplier[id] : 1;
+	}
+	// false if the move runs off a walled board
+	template<class Rules>
+	bool GetNextHeadLocation(int id, Location& new_loc) const;
+	template<class Rules>
+	bool PlanMove(int id, Board& brd);
+	void ClaimTarget(int id);
+	void CheckSwap(int id);
+	// band of a board row, from a table so the tick never divides
+	int RegionOf(int y) const;
+	void Clear(int id, Board& brd);
+	void Crash(int id);
+	uint64_t SnakeKey(int id) const;
+	// move period in wheel time units, at least one
+	uint64_t PeriodOf(int id) const;
+	static uint64_t TicksOf(float seconds);
+	static int ItemSlotsOf(const GameVariables& gVar);
+	void Expire(int slot, Board& brd, Rng& rng);
+	static Color SkinColor(int id, int k);
+
+private:
+	static constexpr int jumpSize = 3;
+	static_assert(jumpSize + 1 <= Topology::maxStride, "jumps must fit the topology tables");
+	static constexpr Color headColor = Colors::Red;
+	static constexpr int growth = 1;
+	static constexpr int spawnDraws = 64;	// spawn cell draws before any free cell will do
+	static constexpr float ticksPerSecond = 1000.0f;	// wheel time unit: a millisecond
+	const Topology& topology;
+	const int nSnakes;
+	const int maxLength;	// segments per snake, [Max Snakelength] or unlimited
+	const int initialLength;
+	const float initialPeriod;
+	const float speedupRate;
+	const uint64_t foodLifetime;	// wheel units, 0 = food stays
+	const uint64_t barrierLifetime;
+	const uint64_t waveInterval;	// 0 = no waves
+	const int waveSize;
+	const int nItemSlots;
+	const int waveEvent;	// event ids: snakes, then item slots, then the wave
+	int firstWanderer;
+
+	// per snake, in the GameState
+	Location* velocity;
+	int* jumpMultiplier;
+	float* movePeriod;	// timestep in seconds
+	int* score;
+	int* pendingGrowth;	// segments still to add, one per move
+	unsigned char* crashed;
+	uint64_t* pHash;
+	unsigned long long* pClock;	// microseconds of game time
+	// an item that expires: where it is and what, the slots not in use
+	struct TimedItem
+	{
+		Location cell;
+		int content;
+	};
+	TimedItem* items;
+	int* freeItems;
+	int* pFreeItemCount;
+
+	SnakeBodies bodies;
+	TimingWheel wheel;
+	// where all of the above lies in the state
+	size_t stateBegin;
+	size_t stateEnd;
+
+	// tick scratch
+	PoolVector<int> due;
+	PoolVector<int> movers;
+	PoolVector<Cell> target;
+	PoolVector<unsigned char> keepsTail;
+	PoolVector<unsigned char> vacated;
+	// one map per band, keyed by cells inside the band, so bands fill them in parallel
+	PoolVector<CellMap> claim;		// mover id entering a cell
+	PoolVector<CellMap> headAt;	// id of the mover whose head is in a cell
+	PoolVector<Location> restored;
+
+	// parallel planning over horizontal bands of bandHeight rows
+	PoolVector<unsigned char> isMover;
+	PoolVector<unsigned char> isLocal;	// target lies in the band of the head
+	int nRegions;
+	int bandHeight;
+	PoolVector<int> bandOfRow;
+	PoolVector<PoolVector<int>> regionSnakes;
+	ThreadPool pool;
+	TickFn tickFn;
+};
@@ -0,0 +1,164 @@
+#include "BitBoard.h"
+#include <assert.h>
+
+BitBoard::BitBoard(GameState& state, int width, int height, const BitBoard* pBase)
+	:
+	width(width),
+	height(height),
+	wordsPerRow((width + wordBits - 1) / wordBits),
+	pState(&state),
+	pBase(pBase)
+{
+	assert(pBase == nullptr || (pBase->width == width && pBase->height == height));
+	const size_t nTiles = size_t((height + tileRows - 1) / tileRows) * wordsPerRow;
+	tiles = state.New<size_t>(nTiles);
+	usedTiles = state.New<size_t>(nTiles);
+	pUsedCount = state.New<size_t>(1);
+	pHash = state.New<uint64_t>(1);
+	*pHash = pBase != nullptr ? pBase->GetHash() : 0;
+}
+
+size_t BitBoard::StateBytes(int width, int height)
+{
+	const size_t nTiles = size_t((height + tileRows - 1) / tileRows) * ((width + wordBits - 1) / wordBits);
+	return 2 * GameState::Bound<size_t>(nTiles) + GameState::Bound<size_t>(1) + GameState::Bound<uint64_t>(1)
+		+ nTiles * GameState::Bound<uint64_t>(tileWords, 64);
+}
+
+uint64_t BitBoard::GetHash() const
+{
+	return *pHash;
+}
+
+uint64_t BitBoard::ComputeHash() const
+{
+	uint64_t hash = 0;
+	for (int content = 1; content <= nPlanes; content++)
+	{
+		ForEach(content, [&](int x, int y) { hash ^= Zobrist::CellKey(x, y, content); });
+	}
+	return hash;
+}
+
+long long BitBoard::Count(int content) const
+{
+	long long n = 0;
+	ForEachTile([&](size_t, const uint64_t* pTile)
+	{
+		for (int i = content - 1; i < tileWords; i += nPlanes)
+		{
+			n += PopCount(pTile[i]);
+		}
+	});
+	return n;
+}
+
+int BitBoard::CountInRow(int content, int y) const
+{
+	int n = 0;
+	for (int w = 0; w < wordsPerRow; w++)
+	{
+		n += PopCount(GetWord(content - 1, y, w));
+	}
+	return n;
+}
+
+bool BitBoard::IsRowEmpty(int y) const
+{
+	const size_t rowOfTiles = size_t(unsigned(y) / tileRows) * wordsPerRow;
+	const int r = (unsigned(y) % tileRows) * nPlanes;
+	uint64_t any = 0;
+	for (int w = 0; w < wordsPerRow; w++)
+	{
+		if (const uint64_t* pTile = GetTile(rowOfTiles + w))
+		{
+			for (int p = 0; p < nPlanes; p++)
+			{
+				any |= pTile[r + p];
+			}
+		}
+	}
+	return any == 0;
+}
+
+int BitBoard::GetWordsPerRow() const
+{
+	return wordsPerRow;
+}
+
+int BitBoard::GetTileCount() const
+{
+	return int(*pUsedCount);
+}
+
+bool BitBoard::IsSpilling() const
+{
+	return pState->IsSpilling();
+}
+
+bool BitBoard::IsIntact() const
+{
+	const size_t nTiles = size_t((height + tileRows - 1) / tileRows) * wordsPerRow;
+	const size_t used = pState->GetUsed();
+	// tiles come after the directory, the list, the count and the hash
+	const size_t firstTile = size_t(reinterpret_cast<const char*>(pHash + 1) - static_cast<const char*>(pState->GetData()));
+	if (used > pState->GetCapacity() || *pUsedCount > nTiles)
+	{
+		return false;
+	}
+	size_t nOwn = 0;
+	for (size_t t = 0; t < nTiles; t++)
+	{
+		if (tiles[t] != 0)
+		{
+			if (tiles[t] < firstTile || tiles[t] % 64 != 0 || tiles[t] > used || used - tiles[t] < tileWords * sizeof(uint64_t))
+			{
+				return false;
+			}
+			nOwn++;
+		}
+	}
+	for (size_t u = 0; u < *pUsedCount; u++)
+	{
+		if (usedTiles[u] >= nTiles || tiles[usedTiles[u]] == 0)
+		{
+			return false;
+		}
+	}
+	return nOwn == *pUsedCount;
+}
+
+void BitBoard::AddCellWrites(int x, int y, TickWrites& writes) const
+{
+	const size_t t = TileIndex(x, y);
+	if (tiles[t] != 0)
+	{
+		writes.Add(tiles[t] + (unsigned(y) % tileRows) * nPlanes * sizeof(uint64_t), nPlanes * sizeof(uint64_t));
+	}
+}
+
+void BitBoard::AddTileWrites(size_t recordedBytes, TickWrites& writes) const
+{
+	writes.Add(pState->OffsetOf(pUsedCount), sizeof(size_t));
+	writes.Add(pState->OffsetOf(pHash), sizeof(uint64_t));
+	// tiles are taken from the end of the block, so the new ones are listed last
+	for (size_t u = *pUsedCount; u > 0 && tiles[usedTiles[u - 1]] >= recordedBytes; u--)
+	{
+		writes.Add(pState->OffsetOf(&usedTiles[u - 1]), sizeof(size_t));
+		writes.Add(pState->OffsetOf(&tiles[usedTiles[u - 1]]), sizeof(size_t));
+	}
+}
+
+uint64_t* BitBoard::NewTile(size_t t)
+{
+	// whole cache lines, so a row of planes never straddles two
+	const uint64_t* pShared = GetTile(t);
+	tiles[t] = pState->Allocate<uint64_t>(tileWords, 64);
+	usedTiles[(*pUsedCount)++] = t;
+	uint64_t* pTile = pState->Get<uint64_t>(tiles[t]);
+	if (pShared != nullptr)
+	{
+		std::copy_n(pShared, tileWords, pTile);
+	}
+	return pTile;
+}
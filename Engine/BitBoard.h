@@ -0,0 +1,238 @@
+#pragma once
+#include "GameState.h"
+#include "TickWrites.h"
+#include "Zobrist.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// Board cell contents as one bit plane per non-empty content (food, poison,
+// barrier, snake); a cell with no bit set is empty. The board is cut into
+// 64 x 64 cell tiles that only get memory once something non-empty is written
+// into them, so a mostly empty 100k x 100k board costs its tile directory and
+// the tiles in use. Inside a tile a row is one word per plane, the four planes
+// of a row next to each other, so reading one cell touches one cache line.
+// Directory, tiles and the list of tiles in use live in the GameState, where
+// new tiles are taken from its end, next to a Zobrist hash of the contents
+// that Set keeps up to date.
+// A BitBoard can sit on top of a read-only base of the same size, a Level
+// shared by many games: tiles it has no copy of read through to the base, and
+// the first change to a base tile copies it into the state. A game then holds
+// only the tiles it changed.
+class BitBoard
+{
+public:
+	static constexpr int nPlanes = 4;
+	static constexpr int wordBits = 64;
+	static constexpr int tileRows = 64;
+	static constexpr int tileWords = tileRows * nPlanes;
+
+public:
+	BitBoard() = default;
+	// pBase, if any, must outlive this and never change
+	BitBoard(GameState& state, int width, int height, const BitBoard* pBase = nullptr);
+	static size_t StateBytes(int width, int height);
+	// content is 0 for empty, otherwise plane + 1
+	int Get(int x, int y) const
+	{
+		const uint64_t* pTile = GetTile(TileIndex(x, y));
+		if (pTile == nullptr)
+		{
+			return 0;
+		}
+		const uint64_t* pGroup = pTile + (unsigned(y) % tileRows) * nPlanes;
+		const uint64_t bit = uint64_t(1) << (unsigned(x) % wordBits);
+		for (int p = 0; p < nPlanes; p++)
+		{
+			if (pGroup[p] & bit)
+			{
+				return p + 1;
+			}
+		}
+		return 0;
+	}
+	void Set(int x, int y, int content)
+	{
+		const size_t t = TileIndex(x, y);
+		uint64_t* pTile = tiles[t] != 0 ? pState->Get<uint64_t>(tiles[t]) : nullptr;
+		if (pTile == nullptr)
+		{
+			// a tile is only copied or created for a real change
+			if (Get(x, y) == content)
+			{
+				return;
+			}
+			pTile = NewTile(t);
+		}
+		uint64_t* pGroup = pTile + (unsigned(y) % tileRows) * nPlanes;
+		const uint64_t bit = uint64_t(1) << (unsigned(x) % wordBits);
+		int old = 0;
+		for (int p = 0; p < nPlanes; p++)
+		{
+			if (pGroup[p] & bit)
+			{
+				old = p + 1;
+			}
+			pGroup[p] &= ~bit;
+		}
+		if (content > 0)
+		{
+			pGroup[content - 1] |= bit;
+		}
+		if (old != content)
+		{
+			*pHash ^= Zobrist::CellKey(x, y, old) ^ Zobrist::CellKey(x, y, content);
+		}
+	}
+	uint64_t GetHash() const;
+	// the same from scratch, to check the incremental one
+	uint64_t ComputeHash() const;
+	long long Count(int content) const;
+	int CountInRow(int content, int y) const;
+	bool IsRowEmpty(int y) const;
+	int GetWordsPerRow() const;
+	// tiles of its own holding memory, out of GetWordsPerRow() * ceil(height / tileRows)
+	int GetTileCount() const;
+	bool IsSpilling() const;
+	// whether the directory and the list of tiles in use only refer to whole
+	// tiles inside the bytes in use, for a block read from a file
+	bool IsIntact() const;
+	// the state a change to cell (x, y) wrote: its row of the tile
+	void AddCellWrites(int x, int y, TickWrites& writes) const;
+	// the count, the hash, and the directory and list entries of the tiles
+	// laid out at or past recordedBytes, the ones new since then
+	void AddTileWrites(size_t recordedBytes, TickWrites& writes) const;
+	// word w of row y of one plane, bits beyond the board width are zero
+	uint64_t GetWord(int plane, int y, int w) const
+	{
+		const uint64_t* pTile = GetTile(size_t(unsigned(y) / tileRows) * wordsPerRow + w);
+		return pTile != nullptr ? pTile[(unsigned(y) % tileRows) * nPlanes + plane] : 0;
+	}
+	// calls f(x, y) for every cell holding content, tile by tile
+	template<typename F>
+	void ForEach(int content, F f) const
+	{
+		ForEachTile([&](size_t t, const uint64_t* pTile)
+		{
+			const int x0 = int(t % wordsPerRow) * wordBits;
+			const int y0 = int(t / wordsPerRow) * tileRows;
+			const uint64_t* pPlane = pTile + (content - 1);
+			for (int r = 0; r < tileRows; r++)
+			{
+				for (uint64_t bits = pPlane[r * nPlanes]; bits != 0; bits &= bits - 1)
+				{
+					f(x0 + LowestBit(bits), y0 + r);
+				}
+			}
+		});
+	}
+	// same for the cells with x0 <= x < x1 and y0 <= y < y1 only, row by row
+	// within a tile; cost follows the number of tiles the rectangle covers
+	template<typename F>
+	void ForEachIn(int content, int x0, int y0, int x1, int y1, F f) const
+	{
+		for (int ty = y0 / tileRows; ty * tileRows < y1; ty++)
+		{
+			const int rBegin = std::max(y0 - ty * tileRows, 0);
+			const int rEnd = std::min(y1 - ty * tileRows, tileRows);
+			for (int tx = x0 / wordBits; tx * wordBits < x1; tx++)
+			{
+				const uint64_t* pTile = GetTile(size_t(ty) * wordsPerRow + tx);
+				if (pTile == nullptr)
+				{
+					continue;
+				}
+				const int lo = std::max(x0 - tx * wordBits, 0);
+				const int hi = std::min(x1 - tx * wordBits, wordBits);
+				const uint64_t mask = (hi == wordBits ? ~uint64_t(0) : (uint64_t(1) << hi) - 1) & ~((uint64_t(1) << lo) - 1);
+				for (int r = rBegin; r < rEnd; r++)
+				{
+					for (uint64_t bits = pTile[r * nPlanes + content - 1] & mask; bits != 0; bits &= bits - 1)
+					{
+						f(tx * wordBits + LowestBit(bits), ty * tileRows + r);
+					}
+				}
+			}
+		}
+	}
+
+	static int PopCount(uint64_t w)
+	{
+#if defined(_MSC_VER) && defined(_M_X64)
+		return int(__popcnt64(w));
+#elif defined(_MSC_VER)
+		return int(__popcnt(static_cast<unsigned int>(w)) + __popcnt(static_cast<unsigned int>(w >> 32)));
+#else
+		return __builtin_popcountll(w);
+#endif
+	}
+	static int LowestBit(uint64_t w)
+	{
+#if defined(_MSC_VER) && defined(_M_X64)
+		unsigned long i;
+		_BitScanForward64(&i, w);
+		return int(i);
+#elif defined(_MSC_VER)
+		unsigned long i;
+		if (_BitScanForward(&i, static_cast<unsigned long>(w)))
+		{
+			return int(i);
+		}
+		_BitScanForward(&i, static_cast<unsigned long>(w >> 32));
+		return int(i) + 32;
+#else
+		return __builtin_ctzll(w);
+#endif
+	}
+
+private:
+	size_t TileIndex(int x, int y) const
+	{
+		return size_t(unsigned(y) / tileRows) * wordsPerRow + unsigned(x) / wordBits;
+	}
+	// this board's copy of the tile, else the base's, else null for all empty
+	const uint64_t* GetTile(size_t t) const
+	{
+		if (tiles[t] != 0)
+		{
+			return pState->Get<uint64_t>(tiles[t]);
+		}
+		return pBase != nullptr ? pBase->GetTile(t) : nullptr;
+	}
+	// a tile of this board's own, starting out as the base has it
+	uint64_t* NewTile(size_t t);
+	// calls f(t, pTile) for every tile holding something, own or shared
+	template<typename F>
+	void ForEachTile(F f) const
+	{
+		for (size_t u = 0; u < *pUsedCount; u++)
+		{
+			f(usedTiles[u], pState->Get<uint64_t>(tiles[usedTiles[u]]));
+		}
+		if (pBase != nullptr)
+		{
+			for (size_t u = 0; u < *pBase->pUsedCount; u++)
+			{
+				const size_t t = pBase->usedTiles[u];
+				if (tiles[t] == 0)
+				{
+					f(t, pBase->GetTile(t));
+				}
+			}
+		}
+	}
+
+private:
+	int width = 0;
+	int height = 0;
+	int wordsPerRow = 0;
+	GameState* pState = nullptr;
+	size_t* tiles = nullptr;		// tile directory, state offset of the tile or 0 = all empty
+	size_t* usedTiles = nullptr;	// directory index of every tile in use, in order of use
+	size_t* pUsedCount = nullptr;
+	uint64_t* pHash = nullptr;
+	const BitBoard* pBase = nullptr;
+};
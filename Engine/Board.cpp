@@ -1,18 +1,65 @@
 #include "Board.h"
 #include <assert.h>
+#include <algorithm>
 #include "Location.h"
-#include "Snake.h"
 
 
-Board::Board(Graphics & gfx_in, Snake& snk_in, GameVariables& gVar)
+Board::Board(Graphics & gfx_in, GameVariables& gVar, GameState& state, MemoryPool& memory)
 	:
 	dimension(gVar.tileSize),
 	gfx(gfx_in),
-	snk(snk_in),
 	width(gVar.boardSizeX),
 	height(gVar.boardSizeY),
-	masterArray(width * height, contentType::empty)// { contentType::empty } )
+	viewWidth(std::min(width, (Graphics::ScreenWidth - startPos.x - 2) / dimension)),
+	viewHeight(std::min(height, (Graphics::ScreenHeight - startPos.y - 2) / dimension)),
+	screenX(PoolAllocator<int>(memory)),
+	screenY(PoolAllocator<int>(memory)),
+	level(Level::Get(gVar)),
+	masterArray(state, width, height, level ? &level->GetCells() : nullptr),
+	spawnWeights{
+		SpawnWeights(state, width, height, SpawnWeights::ParseShape(gVar.foodSpawn)),
+		SpawnWeights(state, width, height, SpawnWeights::ParseShape(gVar.poisonSpawn)),
+		SpawnWeights(state, width, height, SpawnWeights::ParseShape(gVar.barrierSpawn)) },
+	anyWeights(!spawnWeights[0].IsUniform() || !spawnWeights[1].IsUniform() || !spawnWeights[2].IsUniform()),
+	// room for a tick of every snake moving, eating and respawning a few cells long
+	journal(memory, gVar.changeJournal != 0 || gVar.rewindBudget > 0, 8 * size_t(std::max(gVar.numSnakes, gVar.numPlayers)) + 256)
 {
+	// the level's cells are taken from the start
+	if (level && anyWeights)
+	{
+		for (int content = food; content <= snake; content++)
+		{
+			level->GetCells().ForEach(content, [this](int x, int y)
+			{
+				for (SpawnWeights& w : spawnWeights)
+				{
+					if (!w.IsUniform())
+					{
+						w.Take(x, y);
+					}
+				}
+			});
+		}
+	}
+	screenX.reserve(viewWidth);
+	screenY.reserve(viewHeight);
+	// pixel position of every view column and row
+	for (int x = 0; x < viewWidth; x++)
+	{
+		screenX.push_back(startPos.x + cellPadding + x * dimension);
+	}
+	for (int y = 0; y < viewHeight; y++)
+	{
+		screenY.push_back(startPos.y + cellPadding + y * dimension);
+	}
+}
+
+size_t Board::StateBytes(const GameVariables& gVar)
+{
+	return BitBoard::StateBytes(gVar.boardSizeX, gVar.boardSizeY)
+		+ SpawnWeights::StateBytes(gVar.boardSizeX, gVar.boardSizeY, SpawnWeights::ParseShape(gVar.foodSpawn))
+		+ SpawnWeights::StateBytes(gVar.boardSizeX, gVar.boardSizeY, SpawnWeights::ParseShape(gVar.poisonSpawn))
+		+ SpawnWeights::StateBytes(gVar.boardSizeX, gVar.boardSizeY, SpawnWeights::ParseShape(gVar.barrierSpawn));
 }
 
 void Board::DrawCell(const Location& loc, Color c) const
@@ -21,40 +68,41 @@ void Board::DrawCell(const Location& loc, Color c) const
 	assert(loc.x >= 0);
 	assert(loc.y >= 0);
 	assert(loc.y < height);
-	gfx.DrawRectDim(startPos.x+cellPadding+loc.x*dimension, startPos.y+cellPadding+loc.y*dimension, dimension-1*cellPadding, dimension-1*cellPadding, c);
+	const int x = loc.x - viewOrigin.x;
+	const int y = loc.y - viewOrigin.y;
+	if (x < 0 || x >= viewWidth || y < 0 || y >= viewHeight)
+	{
+		return;
+	}
+	gfx.DrawRectDim(screenX[x], screenY[y], dimension-1*cellPadding, dimension-1*cellPadding, c);
 }
 
 void Board::DrawBorders()
 {
 	Color c = Colors::Red;
-	for (int x = startPos.x; x <= startPos.x +1+ width*dimension; x++)
+	for (int x = startPos.x; x <= startPos.x +1+ viewWidth*dimension; x++)
 	{
 		gfx.PutPixel(x, startPos.y, c);
-		gfx.PutPixel(x, startPos.y+1+height*dimension, c);
+		gfx.PutPixel(x, startPos.y+1+viewHeight*dimension, c);
 	}
 
-	for (int y = startPos.y; y <= startPos.y +1+ height*dimension; y++)
+	for (int y = startPos.y; y <= startPos.y +1+ viewHeight*dimension; y++)
 	{
 		gfx.PutPixel(startPos.x, y, c);
-		gfx.PutPixel(startPos.x+1+width*dimension, y, c);
+		gfx.PutPixel(startPos.x+1+viewWidth*dimension, y, c);
 	}
 	
 }
 
 void Board::DrawCellContents()
 {
-	for (int i = 0; i < width * height; i++)
-	{
-		switch (masterArray[i]) 
-		{
-		case contentType::food : DrawCell(Location(i % (width), (i - i % (width)) / (width)), foodColor);
-			break;
-		case contentType::poison : DrawCell(Location(i % (width), (i - i % (width)) / (width)), poisonColor);
-			break;
-		case contentType::barrier : DrawCell(Location(i % (width), (i - i % (width)) / (width)), barrierColor);
-			break;
-		}
-	}
+	const int x0 = viewOrigin.x;
+	const int y0 = viewOrigin.y;
+	const int x1 = x0 + viewWidth;
+	const int y1 = y0 + viewHeight;
+	masterArray.ForEachIn(contentType::food, x0, y0, x1, y1, [this](int x, int y) { DrawCell(Location(x, y), foodColor); });
+	masterArray.ForEachIn(contentType::poison, x0, y0, x1, y1, [this](int x, int y) { DrawCell(Location(x, y), poisonColor); });
+	masterArray.ForEachIn(contentType::barrier, x0, y0, x1, y1, [this](int x, int y) { DrawCell(Location(x, y), barrierColor); });
 }
 
 const int Board::GetWidth()
@@ -72,28 +120,197 @@ bool Board::IsInsideBoard(const Location & loc) const
 	return (loc.x >=0 && loc.x <width) && (loc.y>=0 && loc.y < height);
 }
 
-//void Board::Spawn(contentType cellType, std::mt19937& rng, Snake& snk, int n)
-void Board::Spawn(contentType cellType, std::mt19937& rng, int n)
+void Board::SetViewCenter(const Location& loc)
+{
+	viewOrigin.x = std::max(0, std::min(loc.x - viewWidth / 2, width - viewWidth));
+	viewOrigin.y = std::max(0, std::min(loc.y - viewHeight / 2, height - viewHeight));
+}
+
+Location Board::DrawSpawnCell(Rng& rng) const
+{
+	if (level && !level->GetZones().empty())
+	{
+		return level->DrawZoneCell(rng);
+	}
+	Location loc;
+	loc.x = int(rng.Below(width));
+	loc.y = int(rng.Below(height));
+	return loc;
+}
+
+bool Board::DrawFreeCell(Rng& rng, Location& where) const
+{
+	// column and row drawn separately: uniform over the cells without turning
+	// a linear index back into x and y, and no width*height overflow. On a
+	// board with room one of the first few draws is free.
+	for (int k = 0; k < freeCellDraws; k++)
+	{
+		where.x = int(rng.Below(width));
+		where.y = int(rng.Below(height));
+		if (masterArray.Get(where.x, where.y) == contentType::empty) // snake cells are not empty
+		{
+			return true;
+		}
+	}
+	// nearly full: the k-th free cell, counted row by row
+	auto freeInRow = [this](int y)
+	{
+		int n = width;
+		for (int content = food; content <= snake; content++)
+		{
+			n -= masterArray.CountInRow(content, y);
+		}
+		return n;
+	};
+	long long nFree = 0;
+	for (int y = 0; y < height; y++)
+	{
+		nFree += freeInRow(y);
+	}
+	if (nFree == 0)
+	{
+		return false;
+	}
+	long long k = (long long)rng.BelowWide(uint64_t(nFree));
+	for (where.y = 0; k >= freeInRow(where.y); where.y++)
+	{
+		k -= freeInRow(where.y);
+	}
+	for (where.x = 0;; where.x++)
+	{
+		if (masterArray.Get(where.x, where.y) == contentType::empty && k-- == 0)
+		{
+			return true;
+		}
+	}
+}
+
+void Board::Spawn(contentType cellType, Rng& rng, int n)
 {
-	std::uniform_int_distribution<int> arrayDistr(0, width*height);
-	
 	for (int nSpawns = 0; nSpawns < n; nSpawns++)
 	{
-		int i;
-		do
+		Location where;
+		if (!Spawn(cellType, rng, where))
 		{
-			i = arrayDistr(rng);
-		} while (masterArray[i] != contentType::empty || snk.IsInTile({ i % (width) , (i - i % (width)) / width }));
-		masterArray[i] = cellType;
+			return;
+		}
 	}
 }
 
+bool Board::Spawn(contentType cellType, Rng& rng, Location& where)
+{
+	assert(cellType >= food && cellType <= barrier);
+	const SpawnWeights& weights = spawnWeights[cellType - food];
+	if (!weights.IsUniform())
+	{
+		if (!weights.Sample(rng, where.x, where.y))
+		{
+			return false;
+		}
+	}
+	else if (!DrawFreeCell(rng, where))
+	{
+		return false;
+	}
+	Put(where.x, where.y, cellType);
+	return true;
+}
+
+void Board::Put(int x, int y, contentType content)
+{
+	if (anyWeights)
+	{
+		const bool wasFree = masterArray.Get(x, y) == empty;
+		if (wasFree != (content == empty))
+		{
+			for (SpawnWeights& w : spawnWeights)
+			{
+				if (!w.IsUniform())
+				{
+					if (wasFree)
+					{
+						w.Take(x, y);
+					}
+					else
+					{
+						w.Free(x, y);
+					}
+				}
+			}
+		}
+	}
+	if (journal.IsOn() && masterArray.Get(x, y) != content)
+	{
+		journal.Cell(Location(x, y), content);
+	}
+	masterArray.Set(x, y, content);
+}
+
 Board::contentType Board::GetCellContent(Location loc)
 {
-	return masterArray[loc.y*width+loc.x];
+	return contentType(masterArray.Get(loc.x, loc.y));
 }
 
 void Board::SetCellContent(Location loc, contentType cellContent)
 {
-	masterArray[loc.y * width + loc.x] = cellContent;
+	Put(loc.x, loc.y, cellContent);
+}
+
+long long Board::CountContent(contentType cellContent) const
+{
+	if (cellContent == contentType::empty)
+	{
+		return (long long)width * height - CountContent(food) - CountContent(poison) - CountContent(barrier) - CountContent(snake);
+	}
+	return masterArray.Count(cellContent);
+}
+
+uint64_t Board::GetHash() const
+{
+	return masterArray.GetHash();
+}
+
+uint64_t Board::ComputeHash() const
+{
+	return masterArray.ComputeHash();
+}
+
+bool Board::IsIntact() const
+{
+	return masterArray.IsIntact();
+}
+
+const BitBoard& Board::GetCells() const
+{
+	return masterArray;
+}
+
+ChangeJournal& Board::GetJournal()
+{
+	return journal;
+}
+
+const ChangeJournal& Board::GetJournal() const
+{
+	return journal;
+}
+
+void Board::AddTickWrites(size_t recordedBytes, TickWrites& writes) const
+{
+	for (const ChangeJournal::Record& r : journal)
+	{
+		if (r.kind == ChangeJournal::Kind::rescan)
+		{
+			writes.AddAll();
+		}
+		else if (r.kind == ChangeJournal::Kind::cell)
+		{
+			masterArray.AddCellWrites(r.at.x, r.at.y, writes);
+			for (const SpawnWeights& w : spawnWeights)
+			{
+				w.AddCellWrites(r.at.x, r.at.y, writes);
+			}
+		}
+	}
+	masterArray.AddTileWrites(recordedBytes, writes);
 }
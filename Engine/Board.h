@@ -2,8 +2,16 @@
 #include "Graphics.h"
 #include "Location.h"
 #include "Colors.h"
-#include <random>
+#include "Rng.h"
 #include "GameVariables.h"
+#include "BitBoard.h"
+#include "ChangeJournal.h"
+#include "GameState.h"
+#include "Level.h"
+#include "MemoryPool.h"
+#include "SpawnWeights.h"
+#include "TickWrites.h"
+#include <memory>
 #include <vector>
 
 class Board
@@ -13,38 +21,80 @@ public:
 		empty,
 		food,
 		poison,
-		barrier
+		barrier,
+		snake
 	};
 	static constexpr Color foodColor = Colors::Blue;
 	static constexpr Color barrierColor = Colors::White;
 	static constexpr Color poisonColor = Colors::Magenta;
+	static constexpr Color portalColor = Colors::Cyan;
 
 public:
 	Board() = default;
-	Board(Graphics& gfx_in, class Snake& snk_in, GameVariables& gVar);
+	// the cells live in state, view tables in memory; the level's barriers are
+	// shared with other games and only changed cells are kept in state
+	Board(Graphics& gfx_in, GameVariables& gVar, GameState& state, MemoryPool& memory);
+	static size_t StateBytes(const GameVariables& gVar);
+	// cells outside the view are skipped
 	void DrawCell(const Location& loc, Color c) const;
 	void DrawBorders();
 	void DrawCellContents();
 	const int GetWidth();
 	const int GetHeight();
 	bool IsInsideBoard( const Location& loc) const;
-	//void Spawn(contentType cellType, std::mt19937& rng, class Snake& snk, int n);
-	void Spawn(contentType cellType, std::mt19937& rng, int n);
+	// boards larger than the screen show a window around loc
+	void SetViewCenter(const Location& loc);
+	// where a snake may spawn: anywhere, or in the level's spawn zones; the cell may be taken
+	Location DrawSpawnCell(Rng& rng) const;
+	// a cell drawn uniformly from the free ones, false if there is none
+	bool DrawFreeCell(Rng& rng, Location& where) const;
+	// n items on free cells, placed as [Food Spawn] etc. say (uniform by default)
+	void Spawn(contentType cellType, Rng& rng, int n);
+	// one item, false if no cell is free
+	bool Spawn(contentType cellType, Rng& rng, Location& where);
 	contentType GetCellContent(Location loc);
 	void SetCellContent(Location loc, contentType cellContent);
+	long long CountContent(contentType cellContent) const;
+	// Zobrist hash of the contents, kept up to date cell by cell
+	uint64_t GetHash() const;
+	uint64_t ComputeHash() const;
+	// whether the cells only refer to tiles inside the state, see BitBoard::IsIntact
+	bool IsIntact() const;
+	// bitplane view of the board for whole-board queries and observations
+	const BitBoard& GetCells() const;
+	// the changes of the current tick, with [Change Journal] on or a [Rewind Budget]
+	ChangeJournal& GetJournal();
+	const ChangeJournal& GetJournal() const;
+	// the state the cells journaled this tick wrote, and the tiles laid out
+	// since recordedBytes; everything after a rescan
+	void AddTickWrites(size_t recordedBytes, TickWrites& writes) const;
+
+private:
+	// sets a cell and keeps the spawn weights of free cells up to date
+	void Put(int x, int y, contentType content);
 
 private:
 	int dimension;
 	const Location startPos = { 10,10 };
 	static constexpr int cellPadding = 1;
+	static constexpr int freeCellDraws = 64;	// random draws before free cells are counted
 	Graphics& gfx;
-	Snake& snk;
 	//static constexpr int width =  35;
 	int width;
 	int height;
+	Location viewOrigin = { 0,0 };
+	int viewWidth;
+	int viewHeight;
+	PoolVector<int> screenX;
+	PoolVector<int> screenY;
 	
 	//contentType masterArray[width * height] = { contentType::empty };
 	//contentType* masterArray = nullptr;
-	std::vector<contentType> masterArray;
+	std::shared_ptr<const Level> level;
+	BitBoard masterArray;
+	// spawn weights of food, poison and barriers
+	SpawnWeights spawnWeights[3];
+	bool anyWeights;
+	ChangeJournal journal;
 	
 };
\ No newline at end of file
@@ -0,0 +1,33 @@
+#pragma once
+#include "Location.h"
+#include "Topology.h"
+
+// Move rules as compile-time policies for the tick. AnyShape asks the
+// Topology tables and works for every board. Pow2Torus<logSize> is a torus of
+// 2^logSize x 2^logSize cells without portals: wrap is a mask, nothing is
+// loaded and the compiler sees the board size. Arena picks the instantiation
+// matching the loaded config once, at construction.
+struct AnyShape
+{
+	static bool Advance(const Topology& topology, const Location& loc, int dir, int stride, Location& out)
+	{
+		return topology.Advance(loc, dir, stride, out);
+	}
+};
+
+template<int logSize>
+struct Pow2Torus
+{
+	static constexpr int size = 1 << logSize;
+	static bool Advance(const Topology&, const Location& loc, int dir, int stride, Location& out)
+	{
+		out = { (loc.x + Topology::dx[dir] * stride) & (size - 1), (loc.y + Topology::dy[dir] * stride) & (size - 1) };
+		return true;
+	}
+	// whether this shape can stand in for topology
+	static bool Fits(const Topology& topology)
+	{
+		return topology.GetKind() == Topology::Kind::torus && topology.GetPortalCells().empty()
+			&& topology.GetWidth() == size && topology.GetHeight() == size;
+	}
+};
@@ -0,0 +1,45 @@
+#pragma once
+#include "Location.h"
+#include <cstdint>
+
+// Compact handle for a board cell: x in the low and y in the high 32 bits of
+// one word. Unlike a linear index it is built and taken apart with shifts
+// (no divide by the board width), covers boards past 2^32 cells, and two
+// handles compare in one instruction.
+class Cell
+{
+public:
+	Cell() = default;
+	Cell(const Location& loc)
+		:
+		bits((uint64_t(uint32_t(loc.y)) << 32) | uint32_t(loc.x))
+	{
+	}
+	int X() const
+	{
+		return int(uint32_t(bits));
+	}
+	int Y() const
+	{
+		return int(uint32_t(bits >> 32));
+	}
+	Location ToLocation() const
+	{
+		return { X(), Y() };
+	}
+	uint64_t GetBits() const
+	{
+		return bits;
+	}
+	bool operator==(const Cell& rhs) const
+	{
+		return bits == rhs.bits;
+	}
+	bool operator!=(const Cell& rhs) const
+	{
+		return bits != rhs.bits;
+	}
+
+private:
+	uint64_t bits = 0;
+};
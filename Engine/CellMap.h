@@ -0,0 +1,134 @@
+#pragma once
+#include "Cell.h"
+#include "MemoryPool.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Sparse cell -> int map for per-tick scratch (which snake claims or heads a
+// cell). Open addressing with linear probing; Clear() only bumps a stamp, so
+// the table keeps its capacity and costs nothing to reset. Memory follows the
+// number of entries, not the board size, and grows only past its peak. The
+// table comes from the game's MemoryPool.
+class CellMap
+{
+public:
+	static constexpr int none = -1;
+
+public:
+	CellMap(MemoryPool& memory)
+		:
+		slots(PoolAllocator<Slot>(memory))
+	{
+		Rehash(16);
+	}
+	// room for n entries without growing
+	void Reserve(size_t n)
+	{
+		size_t nSlots = slots.size();
+		while (2 * n > nSlots)
+		{
+			nSlots *= 2;
+		}
+		if (nSlots != slots.size())
+		{
+			Rehash(nSlots);
+		}
+	}
+	void Clear()
+	{
+		count = 0;
+		if (++stamp == 0)
+		{
+			// stamp wrapped, old entries could look current again
+			for (Slot& s : slots)
+			{
+				s.stamp = 0;
+			}
+			stamp = 1;
+		}
+	}
+	int Find(Cell c) const
+	{
+		const uint64_t key = c.GetBits();
+		for (size_t i = Hash(key);; i = (i + 1) & mask)
+		{
+			const Slot& s = slots[i];
+			if (s.stamp != stamp)
+			{
+				return none;
+			}
+			if (s.key == key)
+			{
+				return s.value;
+			}
+		}
+	}
+	// the value stored for c, inserted as none if absent
+	int& operator[](Cell c)
+	{
+		if (2 * (count + 1) > slots.size())
+		{
+			Rehash(2 * slots.size());
+		}
+		const uint64_t key = c.GetBits();
+		size_t i = Hash(key);
+		for (; slots[i].stamp == stamp; i = (i + 1) & mask)
+		{
+			if (slots[i].key == key)
+			{
+				return slots[i].value;
+			}
+		}
+		count++;
+		slots[i] = { key, none, stamp };
+		return slots[i].value;
+	}
+
+private:
+	struct Slot
+	{
+		uint64_t key;
+		int value;
+		unsigned int stamp;
+	};
+	size_t Hash(uint64_t key) const
+	{
+		return size_t((key * 0x9E3779B97F4A7C15ull) >> shift);
+	}
+	void Rehash(size_t nSlots)
+	{
+		PoolVector<Slot> old(nSlots, Slot{ 0, none, 0 }, slots.get_allocator());
+		old.swap(slots);
+		mask = nSlots - 1;
+		shift = 64;
+		for (size_t n = nSlots; n > 1; n >>= 1)
+		{
+			shift--;
+		}
+		const unsigned int oldStamp = stamp;
+		stamp = 1;
+		count = 0;
+		for (const Slot& s : old)
+		{
+			if (s.stamp == oldStamp)
+			{
+				size_t i = Hash(s.key);
+				while (slots[i].stamp == stamp)
+				{
+					i = (i + 1) & mask;
+				}
+				slots[i] = s;
+				slots[i].stamp = stamp;
+				count++;
+			}
+		}
+	}
+
+private:
+	PoolVector<Slot> slots;
+	size_t mask = 0;
+	int shift = 64;
+	size_t count = 0;
+	unsigned int stamp = 1;
+};
@@ -0,0 +1,101 @@
+#pragma once
+#include "Location.h"
+#include "MemoryPool.h"
+#include <cstddef>
+#include <cstdint>
+
+// What changed on the board since the journal was last cleared, for
+// renderers, bots, network sync and the like to follow a game without
+// rescanning it. Board appends a record per cell that changes and Arena one
+// per snake head moving in, tail leaving and snake removed, in the order it
+// happened; consumers read the records in place. Game clears the journal as
+// each tick starts, so after a tick it holds exactly that tick. A rescan
+// record means the state was replaced wholesale (rewind, checkpoint) and
+// consumers have to look at everything again. Off, appending does nothing.
+class ChangeJournal
+{
+public:
+	enum class Kind : uint8_t
+	{
+		cell,	// at became content
+		head,	// snake id's head moved to at
+		tail,	// snake id's tail left at
+		gone,	// snake id was removed from the board
+		rescan
+	};
+	struct Record
+	{
+		Kind kind;
+		uint8_t content;	// a Board::contentType, cell records only
+		int id;				// snake records only
+		Location at;
+	};
+
+public:
+	ChangeJournal(MemoryPool& memory, bool isOn, size_t reserve)
+		:
+		isOn(isOn),
+		records(PoolAllocator<Record>(memory))
+	{
+		if (isOn)
+		{
+			records.reserve(reserve);
+		}
+	}
+	bool IsOn() const
+	{
+		return isOn;
+	}
+	void Cell(const Location& at, int content)
+	{
+		Append({ Kind::cell, uint8_t(content), -1, at });
+	}
+	void Head(int id, const Location& at)
+	{
+		Append({ Kind::head, 0, id, at });
+	}
+	void Tail(int id, const Location& at)
+	{
+		Append({ Kind::tail, 0, id, at });
+	}
+	void Gone(int id)
+	{
+		Append({ Kind::gone, 0, id, Location(0, 0) });
+	}
+	void Rescan()
+	{
+		// whatever came before it no longer matters
+		records.clear();
+		Append({ Kind::rescan, 0, -1, Location(0, 0) });
+	}
+	// keeps the memory, so steady ticks append without allocating
+	void Clear()
+	{
+		records.clear();
+	}
+	const Record* begin() const
+	{
+		return records.data();
+	}
+	const Record* end() const
+	{
+		return records.data() + records.size();
+	}
+	size_t GetSize() const
+	{
+		return records.size();
+	}
+
+private:
+	void Append(const Record& record)
+	{
+		if (isOn)
+		{
+			records.push_back(record);
+		}
+	}
+
+private:
+	bool isOn;
+	PoolVector<Record> records;
+};
@@ -0,0 +1,217 @@
+#include "Checkpoint.h"
+#include "MappedFile.h"
+#include <cstdio>
+#include <cstring>
+#include <type_traits>
+#include <iostream>
+#ifdef _WIN32
+#include "ChiliWin.h"
+#endif
+
+constexpr char Checkpoint::magic[8];
+
+namespace
+{
+	// FNV-1a over values as bytes, strings and vectors with their length
+	class Hasher
+	{
+	public:
+		template<typename T>
+		Hasher& operator<<(const T& value)
+		{
+			static_assert(std::is_arithmetic<T>::value, "hash numbers as bytes");
+			Add(&value, sizeof(value));
+			return *this;
+		}
+		Hasher& operator<<(const std::string& s)
+		{
+			*this << uint64_t(s.size());
+			Add(s.data(), s.size());
+			return *this;
+		}
+		Hasher& operator<<(const std::vector<int>& v)
+		{
+			*this << uint64_t(v.size());
+			Add(v.data(), v.size() * sizeof(int));
+			return *this;
+		}
+		uint64_t Get() const
+		{
+			return hash;
+		}
+
+	private:
+		void Add(const void* p, size_t bytes)
+		{
+			const unsigned char* pBytes = static_cast<const unsigned char*>(p);
+			for (size_t i = 0; i < bytes; i++)
+			{
+				hash = (hash ^ pBytes[i]) * 0x100000001b3ull;
+			}
+		}
+
+	private:
+		uint64_t hash = 0xcbf29ce484222325ull;
+	};
+}
+
+Checkpoint::Checkpoint(const std::string& filename, const GameVariables& gVar)
+	:
+	filename(filename),
+	tmpName(filename + ".tmp"),
+	oldName(filename + ".old"),
+	fingerprint(Fingerprint(gVar)),
+	busy(false),
+	writer(&Checkpoint::WriteLoop, this)
+{
+	// put aside by the run before, which had it mapped
+	std::remove(oldName.c_str());
+}
+
+Checkpoint::~Checkpoint()
+{
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+		quit = true;
+	}
+	wake.notify_one();
+	writer.join();
+}
+
+bool Checkpoint::Save(const GameState& state)
+{
+	if (busy)
+	{
+		return false;
+	}
+	// the only work on the game loop: one memcpy into a buffer kept across saves
+	state.Snapshot(buffer);
+	busy = true;
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+		pendingCapacity = state.GetCapacity();
+		pendingUsed = state.GetUsed();
+		pending = true;
+	}
+	wake.notify_one();
+	return true;
+}
+
+bool Checkpoint::Load(const std::string& filename, const GameVariables& gVar, GameState& state,
+	const std::function<bool()>& isIntact)
+{
+	Header h;
+	{
+		const MappedFile file(filename, MappedFile::Mode::ReadOnly);
+		if (!file.IsOpen() || file.GetSize() < dataOffset)
+		{
+			return false;
+		}
+		memcpy(&h, file.GetData(), sizeof(h));
+		// the layout of a fresh state of this config is a prefix of any saved one
+		if (memcmp(h.magic, magic, sizeof(magic)) != 0 || h.version != version || h.headerBytes != sizeof(Header)
+			|| h.fingerprint != Fingerprint(gVar) || h.capacity != state.GetCapacity() || h.used > h.capacity
+			|| h.used < state.GetUsed() || file.GetSize() - dataOffset < h.capacity)
+		{
+			return false;
+		}
+	}
+	std::vector<uint64_t> fresh;
+	state.Snapshot(fresh);
+	if (!state.MapFile(filename, dataOffset))
+	{
+		return false;
+	}
+	// nothing from the file is followed before its offsets are known to stay inside the block
+	if (state.GetUsed() != h.used || !isIntact())
+	{
+		state.Restore(fresh);
+		return false;
+	}
+	return true;
+}
+
+uint64_t Checkpoint::Fingerprint(const GameVariables& gVar)
+{
+	// what the game plays by; threads, files, drawing and diagnostics are left out
+	Hasher h;
+	h << gVar.boardSizeX << gVar.boardSizeY << gVar.topology << gVar.portals
+		<< gVar.numPlayers << gVar.numSnakes << gVar.maxSnakelength << gVar.initialSnakelength
+		<< gVar.initialSpeed << gVar.speedupRate << gVar.foodAmount << gVar.poisonAmount
+		<< gVar.seed << gVar.stream
+		<< gVar.poisonSpeedup << gVar.barrierOnEat << gVar.jumps
+		<< gVar.levelFile << gVar.levelMaze << gVar.mazeRoomSize << gVar.mazeFill << gVar.levelBarriers << gVar.levelSeed
+		<< gVar.foodLifetime << gVar.barrierLifetime << gVar.timedItems << gVar.waveInterval << gVar.waveSize
+		<< gVar.foodSpawn << gVar.poisonSpawn << gVar.barrierSpawn;
+	return h.Get();
+}
+
+void Checkpoint::WriteLoop()
+{
+	for (;;)
+	{
+		size_t capacity;
+		size_t used;
+		{
+			std::unique_lock<std::mutex> lock(mtx);
+			// a save still pending is written before quitting
+			wake.wait(lock, [this] { return pending || quit; });
+			if (!pending)
+			{
+				return;
+			}
+			pending = false;
+			capacity = pendingCapacity;
+			used = pendingUsed;
+		}
+		Write(capacity, used);
+	}
+}
+
+void Checkpoint::Write(size_t capacity, size_t used)
+{
+	std::remove(tmpName.c_str());
+	bool done = false;
+	{
+		// the whole block is mapped so the file has the length Load maps;
+		// only the bytes in use are written, the rest stays a hole
+		MappedFile file(tmpName, MappedFile::Mode::ReadWrite, 0, dataOffset + capacity);
+		if (file.IsOpen())
+		{
+			Header h;
+			memcpy(h.magic, magic, sizeof(magic));
+			h.version = version;
+			h.headerBytes = sizeof(Header);
+			h.capacity = capacity;
+			h.used = used;
+			h.fingerprint = fingerprint;
+			char* pData = static_cast<char*>(file.GetData());
+			memcpy(pData + dataOffset, buffer.data(), used);
+			memcpy(pData, &h, sizeof(h));
+			file.Flush(true);
+			done = true;
+		}
+	}
+	if (done)
+	{
+#ifdef _WIN32
+		done = MoveFileExA(tmpName.c_str(), filename.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+		if (!done)
+		{
+			// a resumed game keeps the checkpoint it started from mapped, and a
+			// mapped file cannot be replaced, only renamed: it goes aside first
+			// (an older one set aside is no longer mapped and can go)
+			DeleteFileA(oldName.c_str());
+			done = MoveFileExA(filename.c_str(), oldName.c_str(), 0) != 0
+				&& MoveFileExA(tmpName.c_str(), filename.c_str(), MOVEFILE_WRITE_THROUGH) != 0;
+		}
+#else
+		done = std::rename(tmpName.c_str(), filename.c_str()) == 0;
+#endif
+	}
+	if (!done)
+	{
+		std::cerr << "checkpoint " << filename << " could not be written, the previous one stays\n";
+	}
+	busy = false;
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include "GameState.h"
+#include "GameVariables.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Versioned binary checkpoints of a GameState. The file is a header followed,
+// at dataOffset, by the state block exactly as it lies in memory, so resuming
+// maps it back in place (GameState::MapFile) without parsing anything; pages
+// are read as the game touches them. Save copies the state once on the
+// calling thread and hands the copy to a writer thread, kept for the life of
+// the Checkpoint, which writes it into filename.tmp. That file replaces the
+// checkpoint only once it is on disk, so a crash mid-write keeps the previous
+// checkpoint. On Windows the checkpoint a game resumed from is still mapped
+// and is first renamed to filename.old, removed by the next run. Once the
+// buffer has grown to the state, saves allocate nothing. The header carries
+// a fingerprint of the config values the state depends on (seeds, level,
+// rules, topology, sizes), so a checkpoint only resumes the game it came from.
+class Checkpoint
+{
+public:
+	static constexpr uint32_t version = 2;
+
+public:
+	Checkpoint(const std::string& filename, const GameVariables& gVar);
+	Checkpoint(const Checkpoint&) = delete;
+	Checkpoint& operator=(const Checkpoint&) = delete;
+	// waits for a write in flight
+	~Checkpoint();
+	// false if the previous write is still running, the state is then skipped
+	bool Save(const GameState& state);
+	// maps filename into state if it is a checkpoint of this version saved
+	// under the same config and isIntact() holds for what was mapped; if that
+	// check fails the state is copied back as it was
+	static bool Load(const std::string& filename, const GameVariables& gVar, GameState& state,
+		const std::function<bool()>& isIntact);
+	// hash of the config values a saved state only fits under
+	static uint64_t Fingerprint(const GameVariables& gVar);
+
+private:
+	struct Header
+	{
+		char magic[8];
+		uint32_t version;
+		uint32_t headerBytes;
+		uint64_t capacity;
+		uint64_t used;
+		uint64_t fingerprint;
+	};
+	// a multiple of every mapping granularity
+	static constexpr size_t dataOffset = size_t(1) << 16;
+	static constexpr char magic[8] = { 'S','N','E','K','S','T','A','T' };
+	void WriteLoop();
+	void Write(size_t capacity, size_t used);
+
+private:
+	std::string filename;
+	std::string tmpName;
+	std::string oldName;
+	uint64_t fingerprint;
+	std::vector<uint64_t> buffer;
+	std::mutex mtx;
+	std::condition_variable wake;
+	size_t pendingCapacity = 0;
+	size_t pendingUsed = 0;
+	bool pending = false;
+	bool quit = false;
+	std::atomic<bool> busy;
+	std::thread writer;
+};
@@ -0,0 +1,61 @@
+#pragma once
+#include <array>
+#include <cstddef>
+
+// Fixed-capacity container for std::queue<T, FixedRing<T, N>>, so the queue
+// works as before but never allocates. Pushing onto a full ring drops the
+// oldest element, which is where the input buffers trim to anyway.
+template<typename T, size_t N>
+class FixedRing
+{
+public:
+	typedef T value_type;
+	typedef T& reference;
+	typedef const T& const_reference;
+	typedef size_t size_type;
+
+public:
+	bool empty() const
+	{
+		return count == 0;
+	}
+	size_t size() const
+	{
+		return count;
+	}
+	T& front()
+	{
+		return items[first];
+	}
+	const T& front() const
+	{
+		return items[first];
+	}
+	T& back()
+	{
+		return items[(first + count - 1) % N];
+	}
+	const T& back() const
+	{
+		return items[(first + count - 1) % N];
+	}
+	void push_back(const T& item)
+	{
+		if (count == N)
+		{
+			pop_front();
+		}
+		items[(first + count) % N] = item;
+		count++;
+	}
+	void pop_front()
+	{
+		first = (first + 1) % N;
+		count--;
+	}
+
+private:
+	std::array<T, N> items;
+	size_t first = 0;
+	size_t count = 0;
+};
@@ -0,0 +1,150 @@
+#include "FrameCapture.h"
+#include <assert.h>
+#include <algorithm>
+
+namespace
+{
+	FILE* OpenTarget(const std::string& target, bool& isPipe)
+	{
+		FILE* pFile = nullptr;
+		isPipe = !target.empty() && target[0] == '|';
+#ifdef _WIN32
+		if (isPipe)
+		{
+			pFile = _popen(target.c_str() + 1, "wb");
+		}
+		else if (fopen_s(&pFile, target.c_str(), "wb") != 0)
+		{
+			pFile = nullptr;
+		}
+#else
+		pFile = isPipe ? popen(target.c_str() + 1, "w") : fopen(target.c_str(), "wb");
+#endif
+		return pFile;
+	}
+
+	void CloseTarget(FILE* pFile, bool isPipe)
+	{
+#ifdef _WIN32
+		isPipe ? _pclose(pFile) : fclose(pFile);
+#else
+		isPipe ? pclose(pFile) : fclose(pFile);
+#endif
+	}
+}
+
+FrameCapture::FrameCapture(const std::string& target, int width, int height, int fps)
+	:
+	width(width),
+	height(height),
+	frameSize(size_t(width) * size_t(height)),
+	slots(nSlots * frameSize),
+	planes(3 * frameSize)
+{
+	pFile = OpenTarget(target, isPipe);
+	if (pFile)
+	{
+		fprintf(pFile, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C444\n", width, height, fps);
+		running = true;
+		encoder = std::thread(&FrameCapture::EncodeLoop, this);
+	}
+}
+
+FrameCapture::~FrameCapture()
+{
+	if (pFile)
+	{
+		// the encoder drains whatever is still queued before it returns
+		{
+			std::lock_guard<std::mutex> lock(mtx);
+			running = false;
+		}
+		wake.notify_one();
+		encoder.join();
+		CloseTarget(pFile, isPipe);
+		pFile = nullptr;
+	}
+}
+
+bool FrameCapture::IsOpen() const
+{
+	return pFile != nullptr;
+}
+
+void FrameCapture::Submit(const Color* pFrame)
+{
+	if (!pFile)
+	{
+		return;
+	}
+	const unsigned int h = head.load(std::memory_order_relaxed);
+	if (h - tail.load(std::memory_order_acquire) >= nSlots)
+	{
+		// encoder is behind: drop this frame rather than wait for a slot, the
+		// last one queued stands in for it
+		repeats[(h - 1) % nSlots]++;
+		framesDropped++;
+		return;
+	}
+	std::copy_n(pFrame, frameSize, &slots[(h % nSlots) * frameSize]);
+	head.store(h + 1, std::memory_order_release);
+	// taking the lock once orders the store before a waiting encoder's check
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+	}
+	wake.notify_one();
+}
+
+int FrameCapture::GetFramesWritten() const
+{
+	return framesWritten;
+}
+
+int FrameCapture::GetFramesDropped() const
+{
+	return framesDropped;
+}
+
+void FrameCapture::EncodeLoop()
+{
+	for (;;)
+	{
+		const unsigned int t = tail.load(std::memory_order_relaxed);
+		{
+			std::unique_lock<std::mutex> lock(mtx);
+			wake.wait(lock, [&] { return head.load(std::memory_order_acquire) != t || !running; });
+			if (head.load(std::memory_order_acquire) == t)
+			{
+				return;
+			}
+		}
+		WriteFrame(&slots[(t % nSlots) * frameSize]);
+		// the planes still hold this frame
+		for (int n = repeats[t % nSlots].exchange(0); n > 0; n--)
+		{
+			fputs("FRAME\n", pFile);
+			fwrite(planes.data(), 1, planes.size(), pFile);
+		}
+		tail.store(t + 1, std::memory_order_release);
+	}
+}
+
+void FrameCapture::WriteFrame(const Color* pFrame)
+{
+	unsigned char* pY = &planes[0];
+	unsigned char* pCb = &planes[frameSize];
+	unsigned char* pCr = &planes[2 * frameSize];
+	// full range BT.601 in 8.8 fixed point
+	for (size_t i = 0; i < frameSize; i++)
+	{
+		const int r = pFrame[i].GetR();
+		const int g = pFrame[i].GetG();
+		const int b = pFrame[i].GetB();
+		pY[i] = (unsigned char)((77 * r + 150 * g + 29 * b) >> 8);
+		pCb[i] = (unsigned char)(((-43 * r - 85 * g + 128 * b) >> 8) + 128);
+		pCr[i] = (unsigned char)(((128 * r - 107 * g - 21 * b) >> 8) + 128);
+	}
+	fputs("FRAME\n", pFile);
+	fwrite(planes.data(), 1, planes.size(), pFile);
+	framesWritten++;
+}
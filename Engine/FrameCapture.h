@@ -0,0 +1,52 @@
+#pragma once
+#include "Colors.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Records the composed sysbuffer as a y4m (C444) video stream.
+// EndFrame copies the frame into one of a fixed set of preallocated slots and
+// an encoder thread converts and writes it. When all slots are taken the new
+// frame is dropped, so a slow disk or pipe never stalls the game loop; the
+// frame queued last is then written once more in its place, so the stream
+// keeps the frame count, and so the speed, its header promises.
+// A filename starting with '|' is opened as a pipe, e.g. "|ffmpeg -i - out.mp4".
+class FrameCapture
+{
+public:
+	FrameCapture(const std::string& target, int width, int height, int fps);
+	FrameCapture(const FrameCapture&) = delete;
+	FrameCapture& operator=(const FrameCapture&) = delete;
+	~FrameCapture();
+	bool IsOpen() const;
+	void Submit(const Color* pFrame);
+	int GetFramesWritten() const;
+	int GetFramesDropped() const;
+
+private:
+	void EncodeLoop();
+	void WriteFrame(const Color* pFrame);
+
+private:
+	static constexpr unsigned int nSlots = 8;
+	const int width;
+	const int height;
+	const size_t frameSize;
+	bool isPipe = false;
+	FILE* pFile = nullptr;
+	std::vector<Color> slots;				// nSlots frames, written by game thread
+	std::vector<unsigned char> planes;		// Y, Cb, Cr planes, encoder thread only
+	std::atomic<unsigned int> head{ 0 };	// next slot to fill (game thread)
+	std::atomic<unsigned int> tail{ 0 };	// next slot to encode (encoder thread)
+	std::atomic<int> repeats[nSlots] = {};	// frames dropped right after each slot's
+	std::atomic<bool> running{ false };
+	std::mutex mtx;
+	std::condition_variable wake;			// a frame was queued or capture stops
+	std::atomic<int> framesWritten{ 0 };
+	std::atomic<int> framesDropped{ 0 };
+	std::thread encoder;
+};
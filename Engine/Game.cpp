@@ -21,29 +21,86 @@
 #include "MainWindow.h"
 #include "Game.h"
 #include "SpriteCodex.h"
+#include <algorithm>
+#include <fstream>
 
 
 
+constexpr Game::Controls Game::playerControls[];
+
 Game::Game(MainWindow& wnd)
 	:
 	wnd(wnd),
 	gfx(wnd),
-	//gVar(std::string("data.txt")),
-	rng(std::random_device()()),
-	snk1({ 0,0 }, gVar.initialSnakelength, rng),
-	snk2({ gVar.boardSizeX - 1, gVar.boardSizeY - 1 }, gVar.initialSnakelength, rng), // Second snake starts at the opposite corner
-	brd(gfx, snk1, gVar),
-	xDistr(0, brd.GetWidth() - 1),
-	yDistr(0, brd.GetHeight() - 1)
+	nPlayers(std::min(std::max(gVar.numPlayers, 1), maxPlayers)),
+	state(StateBytes(gVar, std::max(gVar.numSnakes, nPlayers)), gVar.spillFile),
+	rng(state.Construct<Rng>(gVar.seed != 0 ? gVar.seed : std::random_device()(), gVar.stream)),
+	tick(state.Construct<unsigned long long>(0ull)),
+	topology(gVar, memory),
+	arena(gVar, topology, std::max(gVar.numSnakes, nPlayers), state, memory),
+	brd(gfx, gVar, state, memory),
+	tickWrites(memory, gVar.rewindBudget > 0 ? 8 * size_t(arena.GetCount()) + 256 : 0)
 {
-	//int coveragePercentage = 10;
-	//int nPoison = Board::GetWidth() * Board::GetHeight() * coveragePercentage / 100;
+	arena.SetWanderers(nPlayers);
+	// a checkpoint brings back snakes, board, rng and tick as they were saved
+	if (!gVar.resume
+		|| !Checkpoint::Load(gVar.checkpointFile, gVar, state, [this] { return arena.IsIntact() && brd.IsIntact(); }))
+	{
+		// first snake starts top-left, second one at the opposite corner, drones
+		// anywhere; a player whose corner is walled off by the level starts anywhere too
+		const Location corners[2] = { { 0,0 }, { gVar.boardSizeX - 1, gVar.boardSizeY - 1 } };
+		for (int id = 0; id < std::min(nPlayers, 2); id++)
+		{
+			if (brd.GetCellContent(corners[id]) == Board::contentType::empty)
+			{
+				arena.Spawn(id, corners[id], brd);
+			}
+			else
+			{
+				arena.SpawnAnywhere(id, brd, rng);
+			}
+		}
+		for (int id = nPlayers; id < arena.GetCount(); id++)
+		{
+			arena.SpawnAnywhere(id, brd, rng);
+		}
+		arena.SpawnItems(Board::contentType::food, std::max(1, gVar.foodAmount), brd, rng);
+		arena.SpawnItems(Board::contentType::poison, gVar.poisonAmount, brd, rng);
+	}
+	// whoever follows the journal starts from the whole board, new or resumed
+	brd.GetJournal().Rescan();
+	if (!gVar.checkpointFile.empty() && gVar.checkpointInterval > 0)
+	{
+		pCheckpoint = std::make_unique<Checkpoint>(gVar.checkpointFile, gVar);
+	}
+	if (gVar.rewindBudget > 0)
+	{
+		pRewind = std::make_unique<RewindBuffer>(size_t(gVar.rewindBudget) << 20, gVar.rewindKeyframes, state.GetCapacity());
+		AddTickWrites();
+		pRewind->Record(state, tickWrites);
+		tickWrites.Clear();
+	}
+
+	if (!gVar.captureFile.empty())
+	{
+		pCapture = std::make_unique<FrameCapture>(gVar.captureFile, Graphics::ScreenWidth, Graphics::ScreenHeight, gVar.captureFps);
+		if (pCapture->IsOpen())
+		{
+			gfx.SetCapture(pCapture.get());
+		}
+	}
+}
 
-	snk1MovePeriod = gVar.initialSpeed;
-	snk2MovePeriod = gVar.initialSpeed;
-	brd.Spawn(Board::contentType::food, rng, std::max(1, gVar.foodAmount));
-	brd.Spawn(Board::contentType::poison, rng, gVar.poisonAmount);
-	brd.Spawn(Board::contentType::barrier, rng, 0);
+Game::~Game()
+{
+	gfx.SetCapture(nullptr);
+	// one line per run, so runs on either backend can be compared side by side
+	if (!gVar.presentLog.empty() && nFrames > 0)
+	{
+		std::ofstream log(gVar.presentLog, std::ios::app);
+		log << "present (" << gfx.GetPresentPath() << "): mean " << 1000.0 * presentTotal / double(nFrames)
+			<< " ms, max " << 1000.0f * presentMax << " ms over " << nFrames << " frames\n";
+	}
 }
 
 void Game::Go()
@@ -52,6 +109,13 @@ void Game::Go()
 	UpdateModel();
 	ComposeFrame();
 	gfx.EndFrame();
+	presentTotal += gfx.GetPresentTime();
+	presentMax = std::max(presentMax, gfx.GetPresentTime());
+	nFrames++;
+	if (gVar.frameLimit > 0 && nFrames >= gVar.frameLimit)
+	{
+		wnd.Kill();
+	}
 }
 
 void Game::UpdateModel()
@@ -59,155 +123,50 @@ void Game::UpdateModel()
 	float dt = frmTime.Mark();
 	if (isStarted)
 	{
-		//Control direction of snake
-		if (wnd.kbd.KeyIsPressed(0x66))	{ snk1.SetSnakeVelocity( { 1, 0} );}	// move right
-		if (wnd.kbd.KeyIsPressed(0x64))	{ snk1.SetSnakeVelocity( {-1, 0} );}	// move left
-		if (wnd.kbd.KeyIsPressed(0x62))	{ snk1.SetSnakeVelocity( { 0, 1} );}	// move down
-		if (wnd.kbd.KeyIsPressed(0x68))	{ snk1.SetSnakeVelocity( { 0,-1} );}	// move up
-		//Adjust speed 
-		if (wnd.kbd.KeyIsPressed(0x61)) { snk1MovePeriod *= 1.05f; }			// slower 7
-		if (wnd.kbd.KeyIsPressed(0x67)) { snk1MovePeriod /= 1.05f; }			// faster 1
-		if (wnd.kbd.KeyIsPressed(0x69)) { snk1.SetSnakeVelocity( { 0,0 } );}	// stall 9
-		//Jump
-		if (wnd.kbd.KeyIsPressed(0x65)) { snk1.JumpOn();}						//jump
-		
-		// Control second snake (if two players)
-		if (gVar.numPlayers == 2)
-		{
-			if (wnd.kbd.KeyIsPressed('D')) { snk2.SetSnakeVelocity({ 1, 0 }); } // move right
-			if (wnd.kbd.KeyIsPressed('A')) { snk2.SetSnakeVelocity({ -1, 0 }); } // move left
-			if (wnd.kbd.KeyIsPressed('X')) { snk2.SetSnakeVelocity({ 0, 1 }); } // move down
-			if (wnd.kbd.KeyIsPressed('W')) { snk2.SetSnakeVelocity({ 0, -1 }); } // move up
-			if (wnd.kbd.KeyIsPressed('Z')) { snk2MovePeriod *= 1.05f; }			// slower
-			if (wnd.kbd.KeyIsPressed('Q')) { snk2MovePeriod /= 1.05f; }			// faster
-			if (wnd.kbd.KeyIsPressed('E')) { snk2.SetSnakeVelocity({0,0}); }	// stall
-			if (wnd.kbd.KeyIsPressed('S')) { snk2.JumpOn(); }
+		ControlPlayers();
 
-		}
-
-
-		if (!gameOver)
+		// backspace runs the game backwards, one tick per frame
+		if (pRewind && wnd.kbd.KeyIsPressed(VK_BACK))
 		{
-			snk1MoveCounter += dt;
-			if (gVar.numPlayers == 2)
-			{
-				snk2MoveCounter += dt;
-			}
-
-			// Move snake 1 if its timer has elapsed
-			if (snk1MoveCounter >= snk1MovePeriod)
+			if (pRewind->StepBack(1, state))
 			{
-				const Location new_loc1 = snk1.GetNextHeadLocation(snk1.GetSnakeVelocity(), brd);
-
-				// Handle food and poison interactions for snake 1
-				if (brd.GetCellContent(new_loc1) == Board::contentType::food)
-				{
-					snk1.Grow(rng);
-					brd.Spawn(Board::contentType::food, rng, 1);
-					brd.Spawn(Board::contentType::barrier, rng, 1);
-					brd.SetCellContent(new_loc1, Board::contentType::empty);
-					// Increase player 1's score
-					player1Score++;
-				}
-
-				if (brd.GetCellContent(new_loc1) == Board::contentType::poison)
-				{
-					brd.SetCellContent(new_loc1, Board::contentType::empty);
-					snk1MovePeriod /= gVar.speedupRate; // Only affects snake 1
-				}
-
-				// Collision detection for snake 1
-				bool snake1Collision = false;
-				if (snk1.IsInTileExceptEnd(new_loc1) && snk1.IsMoving() ||
-					brd.GetCellContent(new_loc1) == Board::contentType::barrier)
-				{
-					snake1Collision = true;
-				}
-
-				// Check if snake 1 collides with snake 2 (if two players)
-				if (gVar.numPlayers == 2 && snk2.IsInTile(new_loc1))
-				{
-					snake1Collision = true;
-				}
-
-				if (snake1Collision)
-				{
-					// Player 1 crashed, reset their score
-					player1Score = 0;
-					crashedPlayer = 1;
-					gameOver = true;
-				}
-
-				// Move snake 1
-				if (!gameOver)
-				{
-					snk1.MoveTo(new_loc1);
-					snk1.JumpOff();
-				}
-
-				snk1MoveCounter = 0;
+				brd.GetJournal().Rescan();
+				gameOver = false;
 			}
+		}
+		else if (!gameOver)
+		{
+			brd.GetJournal().Clear();
+			arena.Tick(dt, brd, rng);
 
-			// Move snake 2 if its timer has elapsed (if two players)
-			if (gVar.numPlayers == 2 && snk2MoveCounter >= snk2MovePeriod)
+			// a crashed player ends the round, crashed drones just come back elsewhere
+			for (int id = 0; id < arena.GetCount(); id++)
 			{
-				const Location new_loc2 = snk2.GetNextHeadLocation(snk2.GetSnakeVelocity(), brd);
-
-				// Handle food and poison interactions for snake 2
-				if (brd.GetCellContent(new_loc2) == Board::contentType::food)
-				{
-					snk2.Grow(rng);
-					brd.Spawn(Board::contentType::food, rng, 1);
-					brd.Spawn(Board::contentType::barrier, rng, 1);
-					brd.SetCellContent(new_loc2, Board::contentType::empty);
-					// Increase player 2's score
-					player2Score++;
-				}
-
-				if (brd.GetCellContent(new_loc2) == Board::contentType::poison)
-				{
-					brd.SetCellContent(new_loc2, Board::contentType::empty);
-					snk2MovePeriod /= gVar.speedupRate; // Only affects snake 2
-				}
-
-				// Collision detection for snake 2
-				bool snake2Collision = false;
-				if (snk2.IsInTileExceptEnd(new_loc2) && snk2.IsMoving() ||
-					brd.GetCellContent(new_loc2) == Board::contentType::barrier)
-				{
-					snake2Collision = true;
-				}
-
-				// Check if snake 2 collides with snake 1
-				if (snk1.IsInTile(new_loc2))
-				{
-					snake2Collision = true;
-				}
-
-				if (snake2Collision)
+				if (arena.IsCrashed(id))
 				{
-					// Player 2 crashed, reset their score
-					player2Score = 0;
-					if (crashedPlayer == 1)
+					if (id < nPlayers)
 					{
-						// Both players crashed
-						crashedPlayer = 3;
+						gameOver = true;
 					}
 					else
 					{
-						crashedPlayer = 2;
+						arena.SpawnAnywhere(id, brd, rng);
 					}
-					gameOver = true;
 				}
-
-				// Move snake 2
-				if (!gameOver)
-				{
-					snk2.MoveTo(new_loc2);
-					snk2.JumpOff();
-				}
-
-				snk2MoveCounter = 0;
+			}
+			// the incremental hashes must agree with a full recount
+			assert(!gVar.hashCheck || (brd.GetHash() == brd.ComputeHash() && arena.GetHash() == arena.ComputeHash()));
+			tick++;
+			if (pRewind)
+			{
+				AddTickWrites();
+				pRewind->Record(state, tickWrites);
+				tickWrites.Clear();
+			}
+			// a checkpoint due while the last one is still being written is skipped
+			if (pCheckpoint && tick % gVar.checkpointInterval == 0)
+			{
+				pCheckpoint->Save(state);
 			}
 		}
 	}
@@ -218,44 +177,76 @@ void Game::UpdateModel()
 		{
 			isStarted = true;
 			gameOver = false;
-			//snk.Reset();
-			// Reset speeds to initial values
-			// Only reset speed for players that crashed
-			if (crashedPlayer == 1 || crashedPlayer == 3) // Player 1 crashed or both crashed
+			// Only reset the players that crashed
+			for (int id = 0; id < nPlayers; id++)
 			{
-				snk1MovePeriod = gVar.initialSpeed;
-				snk1.Reset();
-				
+				if (arena.IsCrashed(id))
+				{
+					arena.Reset(id, brd);
+				}
 			}
-			if (crashedPlayer == 2 || crashedPlayer == 3) // Player 2 crashed or both crashed
+			// the next tick clears the journal before the record that needs it
+			if (pRewind)
 			{
-				snk2MovePeriod = gVar.initialSpeed;
-				snk2.Reset();
+				AddTickWrites();
 			}
-			crashedPlayer = 0;
 		}
 	}
 }
 
+void Game::ControlPlayers()
+{
+	for (int id = 0; id < nPlayers; id++)
+	{
+		const Controls& keys = playerControls[id];
+		//Control direction of snake
+		if (wnd.kbd.KeyIsPressed(keys.right)) { arena.SetSnakeVelocity(id, { 1, 0 }); }
+		if (wnd.kbd.KeyIsPressed(keys.left)) { arena.SetSnakeVelocity(id, { -1, 0 }); }
+		if (wnd.kbd.KeyIsPressed(keys.down)) { arena.SetSnakeVelocity(id, { 0, 1 }); }
+		if (wnd.kbd.KeyIsPressed(keys.up)) { arena.SetSnakeVelocity(id, { 0,-1 }); }
+		//Adjust speed 
+		if (wnd.kbd.KeyIsPressed(keys.slower)) { arena.ScaleMovePeriod(id, 1.05f); }
+		if (wnd.kbd.KeyIsPressed(keys.faster)) { arena.ScaleMovePeriod(id, 1.0f / 1.05f); }
+		if (wnd.kbd.KeyIsPressed(keys.stall)) { arena.SetSnakeVelocity(id, { 0,0 }); }
+		//Jump
+		if (wnd.kbd.KeyIsPressed(keys.jump)) { arena.JumpOn(id); }
+	}
+}
+
+void Game::AddTickWrites()
+{
+	tickWrites.Add(state.OffsetOf(&rng), sizeof(Rng));
+	tickWrites.Add(state.OffsetOf(&tick), sizeof(tick));
+	arena.AddTickWrites(brd.GetJournal(), tickWrites);
+	brd.AddTickWrites(pRewind->GetRecordedBytes(), tickWrites);
+}
+
+size_t Game::StateBytes(const GameVariables& gVar, int nSnakes)
+{
+	return GameState::Bound<Rng>(1) + GameState::Bound<unsigned long long>(1)
+		+ Arena::StateBytes(gVar, nSnakes) + Board::StateBytes(gVar);
+}
+
 void Game::ComposeFrame()
 {
 	if (isStarted)
 	{
+		brd.SetViewCenter(arena.GetCurrentHeadLocation(0));
 		brd.DrawBorders();
 		brd.DrawCellContents();
-		snk1.Draw(brd); // Draw first snake
-		if (gVar.numPlayers == 2)
+		for (const Location& loc : topology.GetPortalCells())
 		{
-			snk2.Draw(brd); // Draw second snake
+			brd.DrawCell(loc, Board::portalColor);
 		}
+		arena.Draw(brd);
 		// Draw score displays
 		// Player 1 score (top-right)
-		SpriteCodex::DrawNumber(player1Score, gfx.ScreenWidth - 50, 10, gfx);
+		SpriteCodex::DrawNumber(arena.GetScore(0), gfx.ScreenWidth - 50, 10, gfx);
 
 		// Player 2 score (top-left) - only in two player mode
-		if (gVar.numPlayers == 2)
+		if (nPlayers > 1)
 		{
-			SpriteCodex::DrawNumber(player2Score, 10, 10, gfx);
+			SpriteCodex::DrawNumber(arena.GetScore(1), 10, 10, gfx);
 		}
 	}
 	else
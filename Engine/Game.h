@@ -25,9 +25,17 @@
 #include "Graphics.h"
 #include "Board.h"
 #include <random>
-#include "Snake.h"
+#include "Arena.h"
+#include "Topology.h"
+#include "GameState.h"
+#include "MemoryPool.h"
+#include "Checkpoint.h"
+#include "RewindBuffer.h"
+#include "TickWrites.h"
 #include "FrameTimer.h"
 #include "GameVariables.h"
+#include "FrameCapture.h"
+#include <memory>
 
 class Game
 {
@@ -35,43 +43,55 @@ public:
 	Game( class MainWindow& wnd );
 	Game( const Game& ) = delete;
 	Game& operator=( const Game& ) = delete;
+	~Game();
 	void Go();
 private:
 	void ComposeFrame();
 	void UpdateModel();
 	/********************************/
 	/*  User Functions              */
-	
+	void ControlPlayers();
+	// what the state took since the last rewind record, see TickWrites
+	void AddTickWrites();
+	static size_t StateBytes(const GameVariables& gVar, int nSnakes);
 	/********************************/
 private:
 	MainWindow& wnd;//init
 	Graphics gfx;//init
 	/********************************/
 	/*  User Variables              */
+	// keys driving one player snake
+	struct Controls
+	{
+		unsigned char right, left, down, up;
+		unsigned char slower, faster, stall, jump;
+	};
+	static constexpr Controls playerControls[] = {
+		{ 0x66, 0x64, 0x62, 0x68, 0x61, 0x67, 0x69, 0x65 },	// numpad
+		{ 'D', 'A', 'X', 'W', 'Z', 'Q', 'E', 'S' }
+	};
+	static constexpr int maxPlayers = int(sizeof(playerControls) / sizeof(playerControls[0]));
+
 	GameVariables gVar = std::string("data.txt");
-	std::mt19937 rng;
-	Snake snk1;
-	Snake snk2;
+	const int nPlayers;	// snakes 0..nPlayers-1 are keyboard driven, the rest are drones
+	GameState state;	// rng, snakes and board cells, see GameState.h
+	MemoryPool memory;	// everything else the game owns, freed in one go
+	Rng& rng;	// reproducible from [Seed] and [Stream]
+	unsigned long long& tick;
+	Topology topology;
+	Arena arena;
 	Board brd;
+	TickWrites tickWrites;	// written since the last rewind record
 
 	FrameTimer frmTime;
+	// EndFrame time of every frame so far, for [Present Log]
+	double presentTotal = 0.0;
+	float presentMax = 0.0f;
+	long long nFrames = 0;
+	std::unique_ptr<FrameCapture> pCapture;
+	std::unique_ptr<Checkpoint> pCheckpoint;
+	std::unique_ptr<RewindBuffer> pRewind;
 	bool gameOver = false;
 	bool isStarted = false;
-	int snkAcceleration = 0;
-	float snk1MovePeriod; // timestep in seconds for snake 1
-	float snk2MovePeriod; // timestep in seconds for snake 2
-	float snk1MoveCounter = 0.0f;
-	float snk2MoveCounter = 0.0f;
-	std::uniform_int_distribution<int> xDistr;
-	std::uniform_int_distribution<int> yDistr;
-
-	// Score variables
-	int player1Score = 0;
-	int player2Score = 0;
-	int crashedPlayer = 0; // 0 = no crash, 1 = player1 crashed, 2 = player2 crashed, 3 = both crashed
 	/********************************/
-	//std::random_device rd;
-	//std::mt19937 rng;
-	//std::uniform_int_distribution<int> cDistr;
-
-};
\ No newline at end of file
+};
@@ -0,0 +1,266 @@
+#include "GameState.h"
+#include <cstdio>
+#include <cstdlib>
+#ifdef _WIN32
+#include "ChiliWin.h"
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+	// Windows reservations are committed in steps of this many bytes
+	constexpr size_t commitStep = size_t(1) << 20;
+}
+
+GameState::GameState(size_t capacity_in, const std::string& spillFile)
+	:
+	capacity(capacity_in + sizeof(Header))
+{
+	if (!spillFile.empty())
+	{
+		// left over from an earlier run, the block must start out zeroed
+		std::remove(spillFile.c_str());
+		spill = MappedFile(spillFile, MappedFile::Mode::ReadWrite, 0, capacity);
+	}
+	if (spill.IsOpen())
+	{
+		pBase = static_cast<char*>(spill.GetData());
+		committed = capacity;
+	}
+	else
+	{
+		// if the spill file cannot be mapped we stay in memory
+#ifdef _WIN32
+		pBase = static_cast<char*>(VirtualAlloc(nullptr, capacity, MEM_RESERVE, PAGE_READWRITE));
+#else
+		void* p = mmap(nullptr, capacity, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+		pBase = p != MAP_FAILED ? static_cast<char*>(p) : nullptr;
+		committed = capacity;
+#endif
+	}
+	if (pBase == nullptr)
+	{
+		capacity = 0;
+		return;
+	}
+	Commit(sizeof(Header));
+	clean = sizeof(Header);
+	GetHeader().used = sizeof(Header);
+	GetHeader().capacity = capacity;
+}
+
+GameState::~GameState()
+{
+	Release();
+}
+
+bool GameState::IsOpen() const
+{
+	return pBase != nullptr;
+}
+
+bool GameState::IsSpilling() const
+{
+	return spill.IsOpen();
+}
+
+const void* GameState::GetData() const
+{
+	return pBase;
+}
+
+size_t GameState::GetUsed() const
+{
+	return size_t(GetHeader().used);
+}
+
+size_t GameState::GetCapacity() const
+{
+	return capacity;
+}
+
+void GameState::Snapshot(std::vector<uint64_t>& out) const
+{
+	// used is a multiple of 8 once anything 8-byte aligned sits at the end;
+	// round up so the last bytes always make it into the snapshot
+	out.resize((GetUsed() + sizeof(uint64_t) - 1) / sizeof(uint64_t));
+	memcpy(out.data(), pBase, GetUsed());
+}
+
+void GameState::Restore(const std::vector<uint64_t>& in)
+{
+	const Header& h = *reinterpret_cast<const Header*>(in.data());
+	assert(in.size() * sizeof(uint64_t) >= h.used && h.capacity == capacity);
+	CopyIn(in.data(), size_t(h.used));
+}
+
+void GameState::CopyFrom(const GameState& other)
+{
+	assert(other.capacity == capacity);
+	if (&other != this)
+	{
+		CopyIn(other.pBase, other.GetUsed());
+	}
+}
+
+void GameState::CopyIn(const void* pSrc, size_t bytes)
+{
+	Commit(bytes);
+	memcpy(pBase, pSrc, bytes);
+	clean = std::max(clean, bytes);
+}
+
+bool GameState::MapFile(const std::string& filename, size_t offset)
+{
+	if (pBase == nullptr)
+	{
+		return false;
+	}
+	char* const pAt = pBase;
+	const size_t bytes = capacity;
+#ifdef _WIN32
+	// shared for delete too, so a checkpoint in use can still be renamed aside
+	HANDLE hf = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (hf == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+	LARGE_INTEGER fileSize;
+	HANDLE hm = nullptr;
+	if (GetFileSizeEx(hf, &fileSize) && size_t(fileSize.QuadPart) >= offset + capacity)
+	{
+		hm = CreateFileMappingA(hf, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+	}
+	CloseHandle(hf);
+	if (hm == nullptr)
+	{
+		return false;
+	}
+	// the reservation has to go before a view can take its place; if the view
+	// fails the block comes back as it was
+	std::vector<uint64_t> saved;
+	Snapshot(saved);
+	Release();
+	pBase = static_cast<char*>(MapViewOfFileEx(hm, FILE_MAP_COPY,
+		DWORD(static_cast<unsigned long long>(offset) >> 32), DWORD(offset & 0xFFFFFFFF), bytes, pAt));
+	if (pBase == nullptr)
+	{
+		CloseHandle(hm);
+		Reclaim(pAt, bytes, saved);
+		return false;
+	}
+	hMapping = hm;
+#else
+	const int fd = open(filename.c_str(), O_RDONLY);
+	if (fd == -1)
+	{
+		return false;
+	}
+	struct stat st;
+	if (fstat(fd, &st) != 0 || size_t(st.st_size) < offset + bytes)
+	{
+		close(fd);
+		return false;
+	}
+	// a spill file is unmapped first, an anonymous block is simply replaced;
+	// a failed fixed mapping may have taken the old one with it, so either way
+	// the block comes back as it was if the file cannot take its place
+	std::vector<uint64_t> saved;
+	Snapshot(saved);
+	if (spill.IsOpen())
+	{
+		Release();
+	}
+	void* p = mmap(pAt, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, off_t(offset));
+	close(fd);
+	if (p == MAP_FAILED)
+	{
+		Release();
+		Reclaim(pAt, bytes, saved);
+		return false;
+	}
+	pBase = static_cast<char*>(p);
+#endif
+	capacity = bytes;
+	isView = true;
+	committed = capacity;
+	clean = GetUsed();
+	return true;
+}
+
+void GameState::Reclaim(char* pAt, size_t bytes, const std::vector<uint64_t>& saved)
+{
+#ifdef _WIN32
+	pBase = static_cast<char*>(VirtualAlloc(pAt, bytes, MEM_RESERVE, PAGE_READWRITE));
+	committed = 0;
+#else
+	void* p = mmap(pAt, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+	if (p != MAP_FAILED && p != pAt)
+	{
+		munmap(p, bytes);
+	}
+	pBase = p == pAt ? pAt : nullptr;
+	committed = bytes;
+#endif
+	// everything laid out in the block points into it: without it there is no going on
+	if (pBase == nullptr)
+	{
+		std::abort();
+	}
+	capacity = bytes;
+	clean = 0;
+	isView = false;
+	CopyIn(saved.data(), size_t(reinterpret_cast<const Header*>(saved.data())->used));
+}
+
+void GameState::Release()
+{
+	if (pBase != nullptr)
+	{
+		if (spill.IsOpen())
+		{
+			spill = MappedFile();
+		}
+		else
+		{
+#ifdef _WIN32
+			if (isView)
+			{
+				UnmapViewOfFile(pBase);
+				CloseHandle(hMapping);
+				hMapping = nullptr;
+			}
+			else
+			{
+				VirtualFree(pBase, 0, MEM_RELEASE);
+			}
+#else
+			munmap(pBase, capacity);
+#endif
+		}
+	}
+	pBase = nullptr;
+	capacity = 0;
+	committed = 0;
+	clean = 0;
+	isView = false;
+}
+
+void GameState::Commit(size_t end)
+{
+#ifdef _WIN32
+	if (end > committed)
+	{
+		const size_t upTo = std::min(capacity, (end + commitStep - 1) / commitStep * commitStep);
+		VirtualAlloc(pBase + committed, upTo - committed, MEM_COMMIT, PAGE_READWRITE);
+		committed = upTo;
+	}
+#else
+	(void)end;
+#endif
+}
@@ -0,0 +1,121 @@
+#pragma once
+#include "MappedFile.h"
+#include <algorithm>
+#include <assert.h>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Everything a game changes while it runs, in one block of memory: the rng,
+// the per-snake data, the snake bodies and the board tiles. The parts are
+// laid out at construction and the pools inside them (tiles, body blocks)
+// grow at the end of the block, so the bytes in use are always one prefix.
+// Nothing in the block is a pointer, parts refer to each other by offset.
+// Snapshot and Restore therefore cost one memcpy of that prefix, and states
+// laid out from the same config can be copied into each other (CopyFrom).
+// The block is reserved at its full capacity up front but pages only take
+// memory once touched, so a mostly empty huge board costs what it uses.
+// With a spill file the block is that file mapped into memory. MapFile puts
+// a saved block (see Checkpoint) in its place.
+class GameState
+{
+public:
+	GameState(size_t capacity, const std::string& spillFile = std::string());
+	GameState(const GameState&) = delete;
+	GameState& operator=(const GameState&) = delete;
+	~GameState();
+	bool IsOpen() const;
+	bool IsSpilling() const;
+	// offset of n zeroed Ts at the end of the block, which must have room
+	template<typename T>
+	size_t Allocate(size_t n, size_t alignment = alignof(T))
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "state must copy as bytes");
+		const size_t offset = (GetUsed() + alignment - 1) / alignment * alignment;
+		const size_t end = offset + n * sizeof(T);
+		assert(end <= capacity);
+		Commit(end);
+		// bytes past clean are untouched and still zero
+		if (offset < clean)
+		{
+			memset(pBase + offset, 0, std::min(end, clean) - offset);
+		}
+		clean = std::max(clean, end);
+		GetHeader().used = end;
+		return offset;
+	}
+	// the most Allocate<T>(n, alignment) can take, for sizing the block
+	template<typename T>
+	static size_t Bound(size_t n, size_t alignment = alignof(T))
+	{
+		return n * sizeof(T) + alignment - 1;
+	}
+	// the Allocate'd array at offset; stays put for the life of the state
+	template<typename T>
+	T* Get(size_t offset) const
+	{
+		return reinterpret_cast<T*>(pBase + offset);
+	}
+	template<typename T>
+	T* New(size_t n)
+	{
+		return Get<T>(Allocate<T>(n));
+	}
+	template<typename T, typename... Args>
+	T& Construct(Args&&... args)
+	{
+		return *new(Get<T>(Allocate<T>(1))) T(std::forward<Args>(args)...);
+	}
+	// the block itself, GetUsed() bytes of it
+	const void* GetData() const;
+	// where p, which points into the block, lies in it
+	size_t OffsetOf(const void* p) const
+	{
+		return size_t(static_cast<const char*>(p) - pBase);
+	}
+	// bytes in use, what a snapshot holds
+	size_t GetUsed() const;
+	size_t GetCapacity() const;
+	void Snapshot(std::vector<uint64_t>& out) const;
+	// back to a snapshot of this state or of one laid out the same way
+	void Restore(const std::vector<uint64_t>& in);
+	void CopyFrom(const GameState& other);
+	// replaces the block with bytes [offset, offset + capacity) of filename,
+	// mapped copy-on-write at the same address: nothing is read before it is
+	// touched and the file is never written. Only while no other thread uses
+	// the state; on failure the state is as it was, at the same address.
+	bool MapFile(const std::string& filename, size_t offset);
+
+private:
+	struct Header
+	{
+		uint64_t used;
+		uint64_t capacity;
+	};
+	Header& GetHeader() const
+	{
+		return *reinterpret_cast<Header*>(pBase);
+	}
+	void CopyIn(const void* pSrc, size_t bytes);
+	// makes [0, end) writable; only Windows reservations need it
+	void Commit(size_t end);
+	void Release();
+	// a fresh block at pAt holding saved, after its mapping was lost
+	void Reclaim(char* pAt, size_t bytes, const std::vector<uint64_t>& saved);
+
+private:
+	char* pBase = nullptr;
+	size_t capacity = 0;
+	size_t committed = 0;
+	size_t clean = 0;		// bytes from here on were never written
+	MappedFile spill;
+	bool isView = false;	// the block is a MapFile view
+#ifdef _WIN32
+	void* hMapping = nullptr;
+#endif
+};
@@ -3,11 +3,12 @@
 #include <fstream>
 #include <string>
 #include <iostream>
+#include <vector>
 
 class GameVariables
 {
 public:
-	GameVariables(std::string& filename)
+	GameVariables(const std::string& filename)
 	{
 		std::ifstream in(filename);
 		for (std::string line; std::getline(in, line); )
@@ -44,6 +45,162 @@ public:
 			{
 				in >> numPlayers;
 			}
+			if (line == "[Num Snakes]")
+			{
+				in >> numSnakes;
+			}
+			if (line == "[Max Snakelength]")
+			{
+				in >> maxSnakelength;
+			}
+			if (line == "[Threads]")
+			{
+				in >> numThreads;
+			}
+			if (line == "[Capture File]")
+			{
+				in >> captureFile;
+			}
+			if (line == "[Capture Fps]")
+			{
+				in >> captureFps;
+			}
+			if (line == "[Present Log]")
+			{
+				in >> presentLog;
+			}
+			if (line == "[Frame Limit]")
+			{
+				in >> frameLimit;
+			}
+			if (line == "[Spill File]")
+			{
+				in >> spillFile;
+			}
+			if (line == "[Checkpoint File]")
+			{
+				in >> checkpointFile;
+			}
+			if (line == "[Checkpoint Interval]")
+			{
+				in >> checkpointInterval;
+			}
+			if (line == "[Resume]")
+			{
+				in >> resume;
+			}
+			if (line == "[Rewind Budget]")
+			{
+				in >> rewindBudget;
+			}
+			if (line == "[Rewind Keyframes]")
+			{
+				in >> rewindKeyframes;
+			}
+			if (line == "[Hash Check]")
+			{
+				in >> hashCheck;
+			}
+			if (line == "[Seed]")
+			{
+				in >> seed;
+			}
+			if (line == "[Stream]")
+			{
+				in >> stream;
+			}
+			if (line == "[Poison Speedup]")
+			{
+				in >> poisonSpeedup;
+			}
+			if (line == "[Barrier On Eat]")
+			{
+				in >> barrierOnEat;
+			}
+			if (line == "[Jumps]")
+			{
+				in >> jumps;
+			}
+			if (line == "[Specialised Boards]")
+			{
+				in >> specialisedBoards;
+			}
+			if (line == "[Topology]")
+			{
+				in >> topology;
+			}
+			if (line == "[Food Spawn]")
+			{
+				in >> foodSpawn;
+			}
+			if (line == "[Poison Spawn]")
+			{
+				in >> poisonSpawn;
+			}
+			if (line == "[Barrier Spawn]")
+			{
+				in >> barrierSpawn;
+			}
+			if (line == "[Food Lifetime]")
+			{
+				in >> foodLifetime;
+			}
+			if (line == "[Barrier Lifetime]")
+			{
+				in >> barrierLifetime;
+			}
+			if (line == "[Timed Items]")
+			{
+				in >> timedItems;
+			}
+			if (line == "[Wave Interval]")
+			{
+				in >> waveInterval;
+			}
+			if (line == "[Wave Size]")
+			{
+				in >> waveSize;
+			}
+			if (line == "[Level File]")
+			{
+				in >> levelFile;
+			}
+			if (line == "[Level Maze]")
+			{
+				in >> levelMaze;
+			}
+			if (line == "[Maze Room Size]")
+			{
+				in >> mazeRoomSize;
+			}
+			if (line == "[Maze Fill]")
+			{
+				in >> mazeFill;
+			}
+			if (line == "[Level Barriers]")
+			{
+				in >> levelBarriers;
+			}
+			if (line == "[Level Seed]")
+			{
+				in >> levelSeed;
+			}
+			if (line == "[Change Journal]")
+			{
+				in >> changeJournal;
+			}
+			if (line == "[Portals]")
+			{
+				// count, then one "x1 y1 x2 y2" line per portal
+				int n = 0;
+				in >> n;
+				for (int i = 0; i < 4 * n; i++)
+				{
+					int v;
+					in >> v;
+					portals.push_back(v);
+				}
+			}
 		}
 	}
 
@@ -57,4 +214,45 @@ public:
 	float initialSpeed;
 	int initialSnakelength;
 	int numPlayers = 1; // Default to single-player mode
+	int numSnakes = 0; // total snakes, the ones beyond numPlayers are computer driven
+	int maxSnakelength = 0; // 0 = no limit
+	int numThreads = 1;
+	std::string captureFile; // empty = no recording, "|cmd" pipes to cmd
+	int captureFps = 60;
+	std::string presentLog; // empty = none, else the file mean and worst present time are appended to on exit
+	int frameLimit = 0; // frames before the game closes itself, 0 = until the window is closed
+	std::string spillFile; // empty = board tiles on the heap, else a file they are paged out to
+	std::string topology = "torus"; // or "walls"
+	std::string checkpointFile; // empty = no checkpoints
+	int checkpointInterval = 0; // ticks between checkpoints, 0 = none
+	int resume = 0; // 1 = carry on from checkpointFile if it fits this config
+	int rewindBudget = 0; // MB for the rewind history and everything it keeps, 0 = none
+	int rewindKeyframes = 64; // ticks between full copies in that history
+	int hashCheck = 0; // 1 = debug builds recompute the state hashes every tick
+	unsigned long long seed = 0; // 0 = a fresh seed every run
+	unsigned long long stream = 0;
+	int specialisedBoards = 1; // 0 = always run the generic tick
+	int changeJournal = 0; // 1 = log every board and snake change of a tick, see ChangeJournal.h
+	// optional rules, 1 = on
+	int poisonSpeedup = 1;
+	int barrierOnEat = 1;
+	int jumps = 1;
+	std::vector<int> portals; // x1 y1 x2 y2 per portal
+	// static barriers shared by every game on the same map: a level file, else a
+	// generated "division" maze or "caves", else this many barriers, from their own seed
+	std::string levelFile;
+	std::string levelMaze;
+	int mazeRoomSize = 4;
+	float mazeFill = 0.45f;
+	int levelBarriers = 0;
+	unsigned long long levelSeed = 1;
+	float foodLifetime = 0.0f; // seconds before uneaten food moves elsewhere, 0 = never
+	float barrierLifetime = 0.0f; // seconds before a barrier goes away, 0 = never
+	int timedItems = 1024; // most items with a lifetime at once, later ones stay
+	float waveInterval = 0.0f; // seconds between waves of extra food, 0 = none
+	int waveSize = 0;
+	// where items spawn: "uniform", "centre" or "edges" (boards up to 2^28 cells)
+	std::string foodSpawn = "uniform";
+	std::string poisonSpawn = "uniform";
+	std::string barrierSpawn = "uniform";
 };
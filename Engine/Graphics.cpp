@@ -20,6 +20,7 @@
 ******************************************************************************************/
 #include "MainWindow.h"
 #include "Graphics.h"
+#include "FrameCapture.h"
 #include "DXErr.h"
 #include "ChiliException.h"
 #include <assert.h>
@@ -240,6 +241,12 @@ Graphics::Graphics( HWNDKey& key )
 		_aligned_malloc( sizeof( Color ) * Graphics::ScreenWidth * Graphics::ScreenHeight,16u ) );
 }
 
+Graphics::Graphics()
+{
+	pSysBuffer = reinterpret_cast<Color*>(
+		_aligned_malloc( sizeof( Color ) * Graphics::ScreenWidth * Graphics::ScreenHeight,16u ) );
+}
+
 Graphics::~Graphics()
 {
 	// free sysbuffer memory (aligned free)
@@ -256,6 +263,19 @@ void Graphics::EndFrame()
 {
 	HRESULT hr;
 
+	// hand the composed frame to the recorder (copies into a free slot or drops)
+	if( pCapture )
+	{
+		pCapture->Submit( pSysBuffer );
+	}
+	// headless, nothing to present to
+	if( !pDevice )
+	{
+		return;
+	}
+
+	presentTimer.Mark();
+
 	// lock and map the adapter memory for copying over the sysbuffer
 	if( FAILED( hr = pImmediateContext->Map( pSysBufferTexture.Get(),0u,
 		D3D11_MAP_WRITE_DISCARD,0u,&mappedSysBufferTexture ) ) )
@@ -299,44 +319,14 @@ void Graphics::EndFrame()
 			throw CHILI_GFX_EXCEPTION( hr,L"Presenting back buffer" );
 		}
 	}
+	presentTime = presentTimer.Mark();
 }
 
-void Graphics::BeginFrame()
-{
-	// clear the sysbuffer
-	memset( pSysBuffer,0u,sizeof( Color ) * Graphics::ScreenHeight * Graphics::ScreenWidth );
-}
-
-void Graphics::PutPixel( int x,int y,Color c )
+const char* Graphics::GetPresentPath() const
 {
-	assert( x >= 0 );
-	assert( x < int( Graphics::ScreenWidth ) );
-	assert( y >= 0 );
-	assert( y < int( Graphics::ScreenHeight ) );
-	pSysBuffer[Graphics::ScreenWidth * y + x] = c;
+	return pDevice ? "D3D11" : "headless";
 }
 
-void Graphics::DrawRect( int x0,int y0,int x1,int y1,Color c )
-{
-	if( x0 > x1 )
-	{
-		std::swap( x0,x1 );
-	}
-	if( y0 > y1 )
-	{
-		std::swap( y0,y1 );
-	}
-
-	for( int y = y0; y < y1; ++y )
-	{
-		for( int x = x0; x < x1; ++x )
-		{
-			PutPixel( x,y,c );
-		}
-	}
-}
-
-
 //////////////////////////////////////////////////
 //           Graphics Exception
 Graphics::Exception::Exception( HRESULT hr,const std::wstring& note,const wchar_t* file,unsigned int line )
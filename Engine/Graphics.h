@@ -19,14 +19,28 @@
 *	along with The Chili DirectX Framework.  If not, see <http://www.gnu.org/licenses/>.  *
 ******************************************************************************************/
 #pragma once
+#ifdef _WIN32
 #include <d3d11.h>
 #include <wrl.h>
+#endif
 #include "ChiliException.h"
 #include "Colors.h"
+#include "FrameTimer.h"
+#include <assert.h>
+#include <cstring>
+#include <memory>
+#include <utility>
 
+class FrameCapture;
+
+// Everything is composed on the CPU into pSysBuffer; the backends only differ in
+// how that buffer reaches the screen. Graphics.cpp (D3D11) maps a texture and
+// copies the buffer into it, GraphicsX11.cpp allocates the buffer in MIT-SHM
+// memory and presents it in place with XShmPutImage.
 class Graphics
 {
 public:
+#ifdef _WIN32
 	class Exception : public ChiliException
 	{
 	public:
@@ -38,31 +52,87 @@ public:
 	private:
 		HRESULT hr;
 	};
+#else
+	class Exception : public ChiliException
+	{
+	public:
+		using ChiliException::ChiliException;
+		virtual std::wstring GetFullMessage() const override { return GetNote() + L"\nAt: " + GetLocation(); }
+		virtual std::wstring GetExceptionType() const override { return L"Chili Graphics Exception"; }
+	};
+#endif
 private:
+#ifdef _WIN32
 	// vertex format for the framebuffer fullscreen textured quad
 	struct FSQVertex
 	{
 		float x,y,z;		// position
 		float u,v;			// texcoords
 	};
+#endif
 public:
 	Graphics( class HWNDKey& key );
+	// headless: frames are composed in the sysbuffer and handed to the capture
+	// but never presented, for tests and benchmarks without a window
+	Graphics();
 	Graphics( const Graphics& ) = delete;
 	Graphics& operator=( const Graphics& ) = delete;
 	void EndFrame();
-	void BeginFrame();
+	void BeginFrame()
+	{
+		// clear the sysbuffer
+		memset( pSysBuffer,0u,sizeof( Color ) * Graphics::ScreenHeight * Graphics::ScreenWidth );
+	}
+	// seconds the last EndFrame spent getting the sysbuffer on screen
+	float GetPresentTime() const
+	{
+		return presentTime;
+	}
+	// how EndFrame gets frames on screen, e.g. "D3D11" or "MIT-SHM"
+	const char* GetPresentPath() const;
+	// frames are handed to the capture at EndFrame until it is detached (nullptr)
+	void SetCapture( FrameCapture* pCapture_in )
+	{
+		pCapture = pCapture_in;
+	}
 	void PutPixel( int x,int y,int r,int g,int b )
 	{
-		PutPixel( x,y,{ unsigned char( r ),unsigned char( g ),unsigned char( b ) } );
+		PutPixel( x,y,{ static_cast<unsigned char>( r ),static_cast<unsigned char>( g ),static_cast<unsigned char>( b ) } );
+	}
+	void PutPixel( int x,int y,Color c )
+	{
+		assert( x >= 0 );
+		assert( x < int( Graphics::ScreenWidth ) );
+		assert( y >= 0 );
+		assert( y < int( Graphics::ScreenHeight ) );
+		pSysBuffer[Graphics::ScreenWidth * y + x] = c;
+	}
+	void DrawRect( int x0,int y0,int x1,int y1,Color c )
+	{
+		if( x0 > x1 )
+		{
+			std::swap( x0,x1 );
+		}
+		if( y0 > y1 )
+		{
+			std::swap( y0,y1 );
+		}
+
+		for( int y = y0; y < y1; ++y )
+		{
+			for( int x = x0; x < x1; ++x )
+			{
+				PutPixel( x,y,c );
+			}
+		}
 	}
-	void PutPixel( int x,int y,Color c );
-	void DrawRect( int x0,int y0,int x1,int y1,Color c );
 	void DrawRectDim( int x0,int y0,int width,int height,Color c )
 	{
 		DrawRect( x0,y0,x0 + width,y0 + height,c );
 	}
 	~Graphics();
 private:
+#ifdef _WIN32
 	Microsoft::WRL::ComPtr<IDXGISwapChain>				pSwapChain;
 	Microsoft::WRL::ComPtr<ID3D11Device>				pDevice;
 	Microsoft::WRL::ComPtr<ID3D11DeviceContext>			pImmediateContext;
@@ -75,7 +145,13 @@ private:
 	Microsoft::WRL::ComPtr<ID3D11InputLayout>			pInputLayout;
 	Microsoft::WRL::ComPtr<ID3D11SamplerState>			pSamplerState;
 	D3D11_MAPPED_SUBRESOURCE							mappedSysBufferTexture;
+#else
+	std::unique_ptr<struct X11Surface>					pSurface;
+#endif
 	Color*                                              pSysBuffer = nullptr;
+	FrameCapture*                                       pCapture = nullptr;
+	FrameTimer											presentTimer;
+	float												presentTime = 0.0f;
 public:
 	static constexpr int ScreenWidth = 800;
 	static constexpr int ScreenHeight = 600;
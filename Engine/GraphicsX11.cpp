@@ -0,0 +1,201 @@
+#include "MainWindow.h"
+#include "Graphics.h"
+#include "FrameCapture.h"
+#include <X11/Xlib.h>
+#include <X11/Xutil.h>
+#include <X11/extensions/XShm.h>
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#include <cstdlib>
+
+#define CHILI_GFX_EXCEPTION( note ) Graphics::Exception( _CRT_WIDE(__FILE__),__LINE__,note )
+
+// X11 side of the sysbuffer. With MIT-SHM the XImage pixels, and therefore the
+// sysbuffer Graphics draws into, live in a SysV segment the server reads directly.
+// Without the extension (e.g. a remote display), or if setting up the segment
+// fails, we fall back to a plain XImage.
+struct X11Surface
+{
+	Display* pDisplay = nullptr;
+	Window window = 0;
+	GC gc = nullptr;
+	XImage* pImage = nullptr;
+	XShmSegmentInfo shmInfo = {};
+	bool useShm = false;
+};
+
+namespace
+{
+	// set by the handler below while XShmAttach is being checked
+	bool shmAttachFailed = false;
+
+	// the server reports a failed attach (BadAccess from a remote display or a
+	// server that cannot reach the segment) asynchronously; note it instead of
+	// letting the default handler exit the process
+	int OnShmAttachError( Display*,XErrorEvent* )
+	{
+		shmAttachFailed = true;
+		return 0;
+	}
+
+	// the image with its pixels in a SysV segment the server attached, or null
+	XImage* CreateShmImage( X11Surface& s,Visual* pVisual,int depth )
+	{
+		XImage* pImage = XShmCreateImage( s.pDisplay,pVisual,depth,ZPixmap,nullptr,&s.shmInfo,
+			Graphics::ScreenWidth,Graphics::ScreenHeight );
+		if( pImage == nullptr )
+		{
+			return nullptr;
+		}
+		if( pImage->bytes_per_line != Graphics::ScreenWidth * int( sizeof( Color ) ) )
+		{
+			XDestroyImage( pImage );
+			return nullptr;
+		}
+		s.shmInfo.shmid = shmget( IPC_PRIVATE,size_t( pImage->bytes_per_line ) * pImage->height,IPC_CREAT | 0600 );
+		if( s.shmInfo.shmid < 0 )
+		{
+			XDestroyImage( pImage );
+			return nullptr;
+		}
+		void* pAddr = shmat( s.shmInfo.shmid,nullptr,0 );
+		if( pAddr == reinterpret_cast<void*>( -1 ) )
+		{
+			shmctl( s.shmInfo.shmid,IPC_RMID,nullptr );
+			XDestroyImage( pImage );
+			return nullptr;
+		}
+		s.shmInfo.shmaddr = pImage->data = static_cast<char*>( pAddr );
+		s.shmInfo.readOnly = False;
+		shmAttachFailed = false;
+		const XErrorHandler previousHandler = XSetErrorHandler( OnShmAttachError );
+		const bool requested = XShmAttach( s.pDisplay,&s.shmInfo ) != 0;
+		// round trip so any error for the attach has arrived before we decide
+		XSync( s.pDisplay,False );
+		XSetErrorHandler( previousHandler );
+		const bool attached = requested && !shmAttachFailed;
+		// segment is destroyed as soon as both sides detach, even if we crash
+		shmctl( s.shmInfo.shmid,IPC_RMID,nullptr );
+		if( !attached )
+		{
+			shmdt( pAddr );
+			pImage->data = nullptr;
+			XDestroyImage( pImage );
+			return nullptr;
+		}
+		return pImage;
+	}
+}
+
+Graphics::Graphics( HWNDKey& key )
+	:
+	pSurface( std::make_unique<X11Surface>() )
+{
+	assert( key.pDisplay != nullptr );
+	X11Surface& s = *pSurface;
+	s.pDisplay = key.pDisplay;
+	s.window = key.window;
+
+	const int screen = DefaultScreen( s.pDisplay );
+	Visual* pVisual = DefaultVisual( s.pDisplay,screen );
+	const int depth = DefaultDepth( s.pDisplay,screen );
+	// Color is 0x00RRGGBB in a 32-bit word, which is the layout of a 24/32 bit TrueColor ZPixmap
+	if( (depth != 24 && depth != 32) || pVisual->red_mask != 0xFF0000 || pVisual->blue_mask != 0xFF )
+	{
+		throw CHILI_GFX_EXCEPTION( L"Display visual is not 24/32-bit XRGB" );
+	}
+	s.gc = XCreateGC( s.pDisplay,s.window,0,nullptr );
+
+	if( XShmQueryExtension( s.pDisplay ) == True )
+	{
+		s.pImage = CreateShmImage( s,pVisual,depth );
+		s.useShm = s.pImage != nullptr;
+	}
+	if( !s.useShm )
+	{
+		char* pData = static_cast<char*>( malloc( sizeof( Color ) * Graphics::ScreenWidth * Graphics::ScreenHeight ) );
+		s.pImage = XCreateImage( s.pDisplay,pVisual,depth,ZPixmap,0,pData,
+			Graphics::ScreenWidth,Graphics::ScreenHeight,32,0 );
+		if( s.pImage == nullptr )
+		{
+			throw CHILI_GFX_EXCEPTION( L"Creating XImage" );
+		}
+	}
+	// the image pixels are the sysbuffer, no intermediate copy at present time
+	pSysBuffer = reinterpret_cast<Color*>( s.pImage->data );
+}
+
+Graphics::Graphics()
+{
+	pSysBuffer = static_cast<Color*>( malloc( sizeof( Color ) * Graphics::ScreenWidth * Graphics::ScreenHeight ) );
+	if( pSysBuffer == nullptr )
+	{
+		throw CHILI_GFX_EXCEPTION( L"Allocating headless sysbuffer" );
+	}
+}
+
+Graphics::~Graphics()
+{
+	if( !pSurface )
+	{
+		free( pSysBuffer );
+		pSysBuffer = nullptr;
+		return;
+	}
+	X11Surface& s = *pSurface;
+	if( s.pImage )
+	{
+		if( s.useShm )
+		{
+			XShmDetach( s.pDisplay,&s.shmInfo );
+			XSync( s.pDisplay,False );
+			shmdt( s.shmInfo.shmaddr );
+			s.pImage->data = nullptr;
+		}
+		XDestroyImage( s.pImage );
+		s.pImage = nullptr;
+		pSysBuffer = nullptr;
+	}
+	if( s.gc )
+	{
+		XFreeGC( s.pDisplay,s.gc );
+	}
+}
+
+void Graphics::EndFrame()
+{
+	// hand the composed frame to the recorder (copies into a free slot or drops)
+	if( pCapture )
+	{
+		pCapture->Submit( pSysBuffer );
+	}
+	if( !pSurface )
+	{
+		return;
+	}
+
+	presentTimer.Mark();
+	X11Surface& s = *pSurface;
+	if( s.useShm )
+	{
+		XShmPutImage( s.pDisplay,s.window,s.gc,s.pImage,0,0,0,0,
+			Graphics::ScreenWidth,Graphics::ScreenHeight,False );
+	}
+	else
+	{
+		XPutImage( s.pDisplay,s.window,s.gc,s.pImage,0,0,0,0,
+			Graphics::ScreenWidth,Graphics::ScreenHeight );
+	}
+	// wait until the server has read the segment before BeginFrame clears it
+	XSync( s.pDisplay,False );
+	presentTime = presentTimer.Mark();
+}
+
+const char* Graphics::GetPresentPath() const
+{
+	if( !pSurface )
+	{
+		return "headless";
+	}
+	return pSurface->useShm ? "MIT-SHM" : "XPutImage";
+}
@@ -65,12 +65,12 @@ bool Keyboard::CharIsEmpty() const
 
 void Keyboard::FlushKey()
 {
-	keybuffer = std::queue<Event>();
+	keybuffer = decltype( keybuffer )();
 }
 
 void Keyboard::FlushChar()
 {
-	charbuffer = std::queue<char>();
+	charbuffer = decltype( charbuffer )();
 }
 
 void Keyboard::Flush()
@@ -114,8 +114,8 @@ void Keyboard::OnChar( char character )
 	TrimBuffer( charbuffer );
 }
 
-template<typename T>
-void Keyboard::TrimBuffer( std::queue<T>& buffer )
+template<typename Q>
+void Keyboard::TrimBuffer( Q& buffer )
 {
 	while( buffer.size() > bufferSize )
 	{
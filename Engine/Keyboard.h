@@ -19,6 +19,7 @@
  *	along with The Chili DirectX Framework.  If not, see <http://www.gnu.org/licenses/>.  *
  ******************************************************************************************/
 #pragma once
+#include "FixedRing.h"
 #include <queue>
 #include <bitset>
 
@@ -85,13 +86,14 @@ private:
 	void OnKeyPressed( unsigned char keycode );
 	void OnKeyReleased( unsigned char keycode );
 	void OnChar( char character );
-	template<typename T>
-	void TrimBuffer( std::queue<T>& buffer );
+	template<typename Q>
+	void TrimBuffer( Q& buffer );
 private:
 	static constexpr unsigned int nKeys = 256u;
 	static constexpr unsigned int bufferSize = 4u;
 	bool autorepeatEnabled = false;
 	std::bitset<nKeys> keystates;
-	std::queue<Event> keybuffer;
-	std::queue<char> charbuffer;
+	// one slot over bufferSize for the push before a trim
+	std::queue<Event,FixedRing<Event,bufferSize + 1u>> keybuffer;
+	std::queue<char,FixedRing<char,bufferSize + 1u>> charbuffer;
 };
\ No newline at end of file
@@ -0,0 +1,268 @@
+#include "Level.h"
+#include "Board.h"
+#include "MappedFile.h"
+#include "MazeGenerator.h"
+#include <algorithm>
+#include <assert.h>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <mutex>
+
+constexpr char Level::magic[8];
+
+namespace
+{
+	// numbers in the file are little-endian whatever the machine, a byte at a time
+	void PutLE32(unsigned char*& p, uint32_t value)
+	{
+		for (int i = 0; i < 4; i++)
+		{
+			*p++ = (unsigned char)(value >> (8 * i));
+		}
+	}
+	void PutLE64(unsigned char*& p, uint64_t value)
+	{
+		for (int i = 0; i < 8; i++)
+		{
+			*p++ = (unsigned char)(value >> (8 * i));
+		}
+	}
+	uint32_t GetLE32(const unsigned char*& p)
+	{
+		uint32_t value = 0;
+		for (int i = 0; i < 4; i++)
+		{
+			value |= uint32_t(*p++) << (8 * i);
+		}
+		return value;
+	}
+	uint64_t GetLE64(const unsigned char*& p)
+	{
+		uint64_t value = 0;
+		for (int i = 0; i < 8; i++)
+		{
+			value |= uint64_t(*p++) << (8 * i);
+		}
+		return value;
+	}
+}
+
+Level::Level(int width, int height)
+	:
+	width(width),
+	height(height),
+	state(BitBoard::StateBytes(width, height)),
+	cells(state, width, height)
+{
+}
+
+std::shared_ptr<const Level> Level::Get(const GameVariables& gVar)
+{
+	MazeGenerator::Params maze = { gVar.boardSizeX, gVar.boardSizeY };
+	const bool isMaze = MazeGenerator::ParseStyle(gVar.levelMaze, maze.style);
+	if (gVar.levelFile.empty() && !isMaze && gVar.levelBarriers <= 0)
+	{
+		return nullptr;
+	}
+	// everything the level is built from
+	const std::string size = std::to_string(gVar.boardSizeX) + ' ' + std::to_string(gVar.boardSizeY) + ' ';
+	const std::string key = !gVar.levelFile.empty() ? "file " + gVar.levelFile
+		: isMaze ? "maze " + size + gVar.levelMaze + ' ' + std::to_string(gVar.mazeRoomSize) + ' '
+		+ std::to_string(gVar.mazeFill) + ' ' + std::to_string(gVar.levelSeed)
+		: size + std::to_string(gVar.levelBarriers) + ' ' + std::to_string(gVar.levelSeed);
+	static std::mutex mtx;
+	static std::map<std::string, std::weak_ptr<const Level>> levels;
+	std::lock_guard<std::mutex> lock(mtx);
+	std::shared_ptr<const Level> level = levels[key].lock();
+	if (!level)
+	{
+		// forget the levels no game uses any more
+		for (auto i = levels.begin(); i != levels.end();)
+		{
+			i = i->second.expired() ? levels.erase(i) : std::next(i);
+		}
+		if (!gVar.levelFile.empty())
+		{
+			level = Load(gVar.levelFile);
+		}
+		else if (isMaze)
+		{
+			maze.roomSize = gVar.mazeRoomSize;
+			maze.fill = gVar.mazeFill;
+			level = MazeGenerator::GenerateOne(maze, gVar.levelSeed);
+		}
+		else
+		{
+			level = Build(gVar);
+		}
+		levels[key] = level;
+	}
+	if (level && (level->width != gVar.boardSizeX || level->height != gVar.boardSizeY))
+	{
+		return nullptr;
+	}
+	return level;
+}
+
+std::shared_ptr<Level> Level::Build(const GameVariables& gVar)
+{
+	auto level = std::make_shared<Level>(gVar.boardSizeX, gVar.boardSizeY);
+	// barriers on distinct cells drawn from the level's own seed, so every
+	// game on the map gets the same ones whatever its own seed
+	Rng rng(gVar.levelSeed);
+	const long long nCells = (long long)gVar.boardSizeX * gVar.boardSizeY;
+	for (long long n = std::min<long long>(gVar.levelBarriers, nCells); n > 0;)
+	{
+		const int x = int(rng.Below(gVar.boardSizeX));
+		const int y = int(rng.Below(gVar.boardSizeY));
+		if (level->cells.Get(x, y) == Board::contentType::empty)
+		{
+			level->Set(x, y, Board::contentType::barrier);
+			n--;
+		}
+	}
+	return level;
+}
+
+std::shared_ptr<Level> Level::Load(const std::string& filename)
+{
+	const MappedFile file(filename, MappedFile::Mode::ReadOnly);
+	if (!file.IsOpen() || file.GetSize() < headerBytes)
+	{
+		return nullptr;
+	}
+	const unsigned char* p = static_cast<const unsigned char*>(file.GetData());
+	if (memcmp(p, magic, sizeof(magic)) != 0)
+	{
+		return nullptr;
+	}
+	p += sizeof(magic);
+	const uint32_t fileVersion = GetLE32(p);
+	const uint32_t width = GetLE32(p);
+	const uint32_t height = GetLE32(p);
+	const uint32_t nZones = GetLE32(p);
+	if (fileVersion != version || width == 0 || height == 0 || width > INT32_MAX || height > INT32_MAX
+		|| file.GetSize() != FileBytes(width, height, nZones))
+	{
+		return nullptr;
+	}
+	auto level = std::make_shared<Level>(int(width), int(height));
+	for (uint32_t z = 0; z < nZones; z++)
+	{
+		Zone zone;
+		zone.x0 = int32_t(GetLE32(p));
+		zone.y0 = int32_t(GetLE32(p));
+		zone.x1 = int32_t(GetLE32(p));
+		zone.y1 = int32_t(GetLE32(p));
+		level->AddZone(zone);
+	}
+	const int wordsPerRow = int((width + BitBoard::wordBits - 1) / BitBoard::wordBits);
+	for (int y = 0; y < int(height); y++)
+	{
+		for (int w = 0; w < wordsPerRow; w++)
+		{
+			uint64_t word = GetLE64(p);
+			// bits past the right edge are ignored
+			while (word != 0)
+			{
+				const int x = w * BitBoard::wordBits + BitBoard::LowestBit(word);
+				word &= word - 1;
+				if (x < int(width))
+				{
+					level->Set(x, y, Board::contentType::barrier);
+				}
+			}
+		}
+	}
+	return level;
+}
+
+bool Level::Save(const std::string& filename) const
+{
+	std::remove(filename.c_str());
+	const uint32_t nZones = uint32_t(zones.size());
+	MappedFile file(filename, MappedFile::Mode::ReadWrite, 0, size_t(FileBytes(uint32_t(width), uint32_t(height), nZones)));
+	if (!file.IsOpen())
+	{
+		return false;
+	}
+	unsigned char* p = static_cast<unsigned char*>(file.GetData());
+	memcpy(p, magic, sizeof(magic));
+	p += sizeof(magic);
+	PutLE32(p, version);
+	PutLE32(p, uint32_t(width));
+	PutLE32(p, uint32_t(height));
+	PutLE32(p, nZones);
+	for (const Zone& zone : zones)
+	{
+		PutLE32(p, uint32_t(zone.x0));
+		PutLE32(p, uint32_t(zone.y0));
+		PutLE32(p, uint32_t(zone.x1));
+		PutLE32(p, uint32_t(zone.y1));
+	}
+	const int barrierPlane = Board::contentType::barrier - 1;
+	for (int y = 0; y < height; y++)
+	{
+		for (int w = 0; w < cells.GetWordsPerRow(); w++)
+		{
+			PutLE64(p, cells.GetWord(barrierPlane, y, w));
+		}
+	}
+	file.Flush(true);
+	return true;
+}
+
+uint64_t Level::FileBytes(uint32_t width, uint32_t height, uint32_t nZones)
+{
+	const uint64_t wordsPerRow = (uint64_t(width) + BitBoard::wordBits - 1) / BitBoard::wordBits;
+	return headerBytes + uint64_t(nZones) * zoneBytes + uint64_t(height) * wordsPerRow * sizeof(uint64_t);
+}
+
+void Level::Set(int x, int y, int content)
+{
+	cells.Set(x, y, content);
+}
+
+void Level::AddZone(const Zone& zone)
+{
+	const Zone clipped = { std::max(zone.x0, 0), std::max(zone.y0, 0),
+		std::min(zone.x1, width), std::min(zone.y1, height) };
+	if (clipped.x0 >= clipped.x1 || clipped.y0 >= clipped.y1)
+	{
+		return;
+	}
+	zones.push_back(clipped);
+	zoneEnds.push_back((zoneEnds.empty() ? 0 : zoneEnds.back())
+		+ (long long)(clipped.x1 - clipped.x0) * (clipped.y1 - clipped.y0));
+}
+
+int Level::GetWidth() const
+{
+	return width;
+}
+
+int Level::GetHeight() const
+{
+	return height;
+}
+
+const BitBoard& Level::GetCells() const
+{
+	return cells;
+}
+
+const std::vector<Level::Zone>& Level::GetZones() const
+{
+	return zones;
+}
+
+Location Level::DrawZoneCell(Rng& rng) const
+{
+	assert(!zones.empty());
+	// a zone by its number of cells, then a cell inside it
+	const uint64_t r = rng.BelowWide(uint64_t(zoneEnds.back()));
+	const size_t i = std::upper_bound(zoneEnds.begin(), zoneEnds.end(), (long long)r) - zoneEnds.begin();
+	const Zone& zone = zones[i];
+	return { zone.x0 + int(rng.Below(zone.x1 - zone.x0)), zone.y0 + int(rng.Below(zone.y1 - zone.y0)) };
+}
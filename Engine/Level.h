@@ -0,0 +1,74 @@
+#pragma once
+#include "BitBoard.h"
+#include "GameState.h"
+#include "GameVariables.h"
+#include "Location.h"
+#include "Rng.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// The static part of a board, the barriers a game on some map starts out
+// with, and optionally the zones its snakes spawn in. It is built once and
+// only read from then on, so any number of games on the same map share one
+// Level: their BitBoards read through to it and keep copies of just the
+// tiles they change (see BitBoard).
+// A level file holds the barriers only, in the same form whatever the word
+// size or byte order of the machine that wrote it: a header (magic, version,
+// width, height, zone count), the zones as four 32-bit ints each, then the
+// barrier plane row by row, ceil(width / 64) 64-bit words per row with cell x
+// at bit x % 64 of word x / 64. Every number is little-endian. Load rebuilds
+// the tiles from the rows, skipping empty words.
+class Level
+{
+public:
+	// cells x0 <= x < x1, y0 <= y < y1
+	struct Zone
+	{
+		int x0;
+		int y0;
+		int x1;
+		int y1;
+	};
+	static constexpr uint32_t version = 2;
+
+public:
+	// an empty level, filled with Set before it is shared
+	Level(int width, int height);
+	Level(const Level&) = delete;
+	Level& operator=(const Level&) = delete;
+	// the level gVar describes, [Level File], [Level Maze] or [Level Barriers], the same
+	// object for every game asking for it while one of them still holds it;
+	// null if gVar asks for none or the file does not fit the board
+	static std::shared_ptr<const Level> Get(const GameVariables& gVar);
+	// null unless filename is a whole level file of this version
+	static std::shared_ptr<Level> Load(const std::string& filename);
+	bool Save(const std::string& filename) const;
+	void Set(int x, int y, int content);
+	// zones are clipped to the board, empty ones are dropped
+	void AddZone(const Zone& zone);
+	int GetWidth() const;
+	int GetHeight() const;
+	const BitBoard& GetCells() const;
+	const std::vector<Zone>& GetZones() const;
+	// a cell drawn uniformly from the zones, which must not be empty
+	Location DrawZoneCell(Rng& rng) const;
+
+private:
+	// magic, then version, width, height and zone count as 32-bit words
+	static constexpr size_t headerBytes = 8 + 4 * 4;
+	static constexpr size_t zoneBytes = 4 * 4;
+	static constexpr char magic[8] = { 'S','N','E','K','L','E','V','L' };
+	// the file length for a level of this size
+	static uint64_t FileBytes(uint32_t width, uint32_t height, uint32_t nZones);
+	static std::shared_ptr<Level> Build(const GameVariables& gVar);
+
+private:
+	int width;
+	int height;
+	GameState state;
+	BitBoard cells;
+	std::vector<Zone> zones;
+	std::vector<long long> zoneEnds;	// cells in zones up to and including each
+};
@@ -19,6 +19,9 @@
 *	along with The Chili DirectX Framework.  If not, see <http://www.gnu.org/licenses/>.  *
 ******************************************************************************************/
 #pragma once
+#ifndef _WIN32
+#include "X11Window.h"
+#else
 #include "ChiliWin.h"
 #include "Graphics.h"
 #include "Keyboard.h"
@@ -78,4 +81,5 @@ private:
 	static constexpr wchar_t* wndClassName = L"Chili DirectX Framework Window";
 	HINSTANCE hInst = nullptr;
 	std::wstring args;
-};
\ No newline at end of file
+};
+#endif
@@ -0,0 +1,211 @@
+#include "MappedFile.h"
+#include <algorithm>
+#include <utility>
+#ifdef _WIN32
+#include "ChiliWin.h"
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+MappedFile::MappedFile(const std::string& filename, Mode mode, size_t offset, size_t size_in)
+{
+	const bool write = mode == Mode::ReadWrite;
+	HANDLE hf = CreateFileA(filename.c_str(), write ? (GENERIC_READ | GENERIC_WRITE) : GENERIC_READ,
+		FILE_SHARE_READ, nullptr, write ? OPEN_ALWAYS : OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (hf == INVALID_HANDLE_VALUE)
+	{
+		return;
+	}
+	hFile = hf;
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(hf, &fileSize))
+	{
+		Close();
+		return;
+	}
+	size_t end = offset + size_in;
+	if (size_in == 0)
+	{
+		if (write || size_t(fileSize.QuadPart) <= offset)
+		{
+			Close();
+			return;
+		}
+		end = size_t(fileSize.QuadPart);
+	}
+	else if (!write && size_t(fileSize.QuadPart) < end)
+	{
+		Close();
+		return;
+	}
+	// a mapping larger than the file grows the file
+	const unsigned long long mapSize = write ? std::max(static_cast<unsigned long long>(end), static_cast<unsigned long long>(fileSize.QuadPart)) : 0;
+	hMapping = CreateFileMappingA(hf, nullptr, write ? PAGE_READWRITE : PAGE_READONLY,
+		DWORD(mapSize >> 32), DWORD(mapSize & 0xFFFFFFFF), nullptr);
+	if (hMapping == nullptr)
+	{
+		Close();
+		return;
+	}
+	pData = MapViewOfFile(hMapping, write ? FILE_MAP_WRITE : FILE_MAP_READ,
+		DWORD(static_cast<unsigned long long>(offset) >> 32), DWORD(offset & 0xFFFFFFFF), end - offset);
+	if (pData == nullptr)
+	{
+		Close();
+		return;
+	}
+	size = end - offset;
+}
+
+void MappedFile::Flush(bool wait) const
+{
+	if (pData != nullptr)
+	{
+		FlushViewOfFile(pData, size);
+		if (wait)
+		{
+			FlushFileBuffers(hFile);
+		}
+	}
+}
+
+size_t MappedFile::GetGranularity()
+{
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	return size_t(info.dwAllocationGranularity);
+}
+
+void MappedFile::Close()
+{
+	if (pData != nullptr)
+	{
+		UnmapViewOfFile(pData);
+	}
+	if (hMapping != nullptr)
+	{
+		CloseHandle(hMapping);
+	}
+	if (hFile != nullptr)
+	{
+		CloseHandle(hFile);
+	}
+	pData = nullptr;
+	hMapping = nullptr;
+	hFile = nullptr;
+	size = 0;
+}
+#else
+MappedFile::MappedFile(const std::string& filename, Mode mode, size_t offset, size_t size_in)
+{
+	const bool write = mode == Mode::ReadWrite;
+	fd = open(filename.c_str(), write ? (O_RDWR | O_CREAT) : O_RDONLY, 0644);
+	if (fd == -1)
+	{
+		return;
+	}
+	struct stat st;
+	if (fstat(fd, &st) != 0)
+	{
+		Close();
+		return;
+	}
+	size_t end = offset + size_in;
+	if (size_in == 0)
+	{
+		if (write || size_t(st.st_size) <= offset)
+		{
+			Close();
+			return;
+		}
+		end = size_t(st.st_size);
+	}
+	else if (size_t(st.st_size) < end && (!write || ftruncate(fd, off_t(end)) != 0))
+	{
+		Close();
+		return;
+	}
+	void* p = mmap(nullptr, end - offset, write ? (PROT_READ | PROT_WRITE) : PROT_READ, MAP_SHARED, fd, off_t(offset));
+	if (p == MAP_FAILED)
+	{
+		Close();
+		return;
+	}
+	pData = p;
+	size = end - offset;
+}
+
+void MappedFile::Flush(bool wait) const
+{
+	if (pData != nullptr)
+	{
+		msync(pData, size, wait ? MS_SYNC : MS_ASYNC);
+	}
+}
+
+size_t MappedFile::GetGranularity()
+{
+	return size_t(sysconf(_SC_PAGESIZE));
+}
+
+void MappedFile::Close()
+{
+	if (pData != nullptr)
+	{
+		munmap(pData, size);
+	}
+	if (fd != -1)
+	{
+		close(fd);
+	}
+	pData = nullptr;
+	fd = -1;
+	size = 0;
+}
+#endif
+
+MappedFile::MappedFile(MappedFile&& other)
+{
+	*this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other)
+{
+	if (this != &other)
+	{
+		Close();
+		std::swap(pData, other.pData);
+		std::swap(size, other.size);
+#ifdef _WIN32
+		std::swap(hFile, other.hFile);
+		std::swap(hMapping, other.hMapping);
+#else
+		std::swap(fd, other.fd);
+#endif
+	}
+	return *this;
+}
+
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+bool MappedFile::IsOpen() const
+{
+	return pData != nullptr;
+}
+
+void* MappedFile::GetData() const
+{
+	return pData;
+}
+
+size_t MappedFile::GetSize() const
+{
+	return size;
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+// A memory-mapped range of a file (POSIX mmap / Win32 file mapping).
+// ReadWrite mappings create the file if needed and grow it to cover the range;
+// changes go back to the file through the page cache. Failure leaves the
+// object closed (IsOpen() == false) instead of throwing.
+class MappedFile
+{
+public:
+	enum class Mode
+	{
+		ReadOnly,
+		ReadWrite
+	};
+
+public:
+	MappedFile() = default;
+	// size 0 maps from offset to the end of the file (ReadOnly only)
+	MappedFile(const std::string& filename, Mode mode, size_t offset = 0, size_t size = 0);
+	MappedFile(MappedFile&& other);
+	MappedFile& operator=(MappedFile&& other);
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+	~MappedFile();
+	bool IsOpen() const;
+	void* GetData() const;
+	size_t GetSize() const;
+	// starts writing dirty pages back; with wait also blocks until they are on disk
+	void Flush(bool wait) const;
+	// offsets passed to the constructor must be a multiple of this
+	static size_t GetGranularity();
+
+private:
+	void Close();
+
+private:
+	void* pData = nullptr;
+	size_t size = 0;
+#ifdef _WIN32
+	void* hFile = nullptr;
+	void* hMapping = nullptr;
+#else
+	int fd = -1;
+#endif
+};
@@ -0,0 +1,263 @@
+#include "MazeGenerator.h"
+#include "Board.h"
+#include <algorithm>
+#include <assert.h>
+#include <climits>
+
+MazeGenerator::MazeGenerator(int nThreads)
+	:
+	pool(nThreads)
+{
+}
+
+bool MazeGenerator::ParseStyle(const std::string& name, Style& style)
+{
+	if (name == "division")
+	{
+		style = Style::division;
+		return true;
+	}
+	if (name == "caves")
+	{
+		style = Style::caves;
+		return true;
+	}
+	return false;
+}
+
+std::vector<std::shared_ptr<Level>> MazeGenerator::Generate(const Params& params, uint64_t seed, int count)
+{
+	// the generators are split up front, so no arena depends on scheduling
+	std::vector<Rng> rngs;
+	rngs.reserve(count);
+	Rng rng(seed);
+	for (int i = 0; i < count; i++)
+	{
+		rngs.push_back(rng.Split());
+	}
+	std::vector<std::shared_ptr<Level>> levels(count);
+	auto task = [&](int i)
+	{
+		levels[i] = Build(params, rngs[i]);
+	};
+	pool.ParallelFor(count, task);
+	return levels;
+}
+
+std::shared_ptr<Level> MazeGenerator::GenerateOne(const Params& params, uint64_t seed)
+{
+	return Build(params, Rng(seed));
+}
+
+std::shared_ptr<Level> MazeGenerator::Build(const Params& params, Rng rng)
+{
+	assert(params.width > 0 && params.height > 0);
+	assert((long long)params.width * params.height <= INT_MAX);
+	Grid walls(size_t(params.width) * params.height, 0);
+	if (params.style == Style::division)
+	{
+		Divide(params, rng, walls);
+	}
+	else
+	{
+		Caves(params, rng, walls);
+	}
+	Connect(params, walls);
+
+	auto level = std::make_shared<Level>(params.width, params.height);
+	for (int y = 0; y < params.height; y++)
+	{
+		const unsigned char* pRow = &walls[size_t(y) * params.width];
+		for (int x = 0; x < params.width; x++)
+		{
+			if (pRow[x])
+			{
+				level->Set(x, y, Board::contentType::barrier);
+			}
+		}
+	}
+	return level;
+}
+
+void MazeGenerator::Divide(const Params& params, Rng& rng, Grid& walls)
+{
+	struct Chamber
+	{
+		int x0;
+		int y0;
+		int x1;
+		int y1;
+	};
+	const int room = std::max(1, params.roomSize);
+	// chambers still to split, depth first
+	std::vector<Chamber> todo = { { 0, 0, params.width, params.height } };
+	while (!todo.empty())
+	{
+		const Chamber c = todo.back();
+		todo.pop_back();
+		const int w = c.x1 - c.x0;
+		const int h = c.y1 - c.y0;
+		const bool canRows = h >= 2 * room + 1;
+		const bool canCols = w >= 2 * room + 1;
+		if (!canRows && !canCols)
+		{
+			continue;
+		}
+		// across the longer side, so rooms stay roughly square
+		const bool rows = canRows && (!canCols || h > w || (h == w && rng.Below(2) == 0));
+		if (rows)
+		{
+			const int y = c.y0 + room + int(rng.Below(h - 2 * room));
+			const int door = std::min(std::max(1, params.doorWidth), w);
+			const int d0 = c.x0 + int(rng.Below(w - door + 1));
+			for (int x = c.x0; x < c.x1; x++)
+			{
+				walls[size_t(y) * params.width + x] = x < d0 || x >= d0 + door;
+			}
+			todo.push_back({ c.x0, c.y0, c.x1, y });
+			todo.push_back({ c.x0, y + 1, c.x1, c.y1 });
+		}
+		else
+		{
+			const int x = c.x0 + room + int(rng.Below(w - 2 * room));
+			const int door = std::min(std::max(1, params.doorWidth), h);
+			const int d0 = c.y0 + int(rng.Below(h - door + 1));
+			for (int y = c.y0; y < c.y1; y++)
+			{
+				walls[size_t(y) * params.width + x] = y < d0 || y >= d0 + door;
+			}
+			todo.push_back({ c.x0, c.y0, x, c.y1 });
+			todo.push_back({ x + 1, c.y0, c.x1, c.y1 });
+		}
+	}
+}
+
+void MazeGenerator::Caves(const Params& params, Rng& rng, Grid& walls)
+{
+	const int width = params.width;
+	const int height = params.height;
+	const uint32_t threshold = uint32_t(std::min(std::max(params.fill, 0.0f), 1.0f) * float(1u << 24));
+	// a ring of walls around the board, so the rule needs no bounds checks
+	const size_t stride = size_t(width) + 2;
+	Grid cur(stride * (height + 2), 1);
+	Grid next(cur);
+	for (int y = 0; y < height; y++)
+	{
+		for (int x = 0; x < width; x++)
+		{
+			cur[(y + 1) * stride + x + 1] = (rng() >> 40) < threshold;
+		}
+	}
+	// a cell becomes wall with at least 5 walls among itself and its 8
+	// neighbours, cells off the board counting as walls
+	for (int step = 0; step < params.smoothSteps; step++)
+	{
+		for (int y = 1; y <= height; y++)
+		{
+			const unsigned char* pUp = &cur[(y - 1) * stride];
+			const unsigned char* pMid = pUp + stride;
+			const unsigned char* pDown = pMid + stride;
+			unsigned char* pOut = &next[y * stride];
+			for (size_t x = 1; x <= size_t(width); x++)
+			{
+				const int n = pUp[x - 1] + pUp[x] + pUp[x + 1] + pMid[x - 1] + pMid[x] + pMid[x + 1]
+					+ pDown[x - 1] + pDown[x] + pDown[x + 1];
+				pOut[x] = n >= 5;
+			}
+		}
+		cur.swap(next);
+	}
+	for (int y = 0; y < height; y++)
+	{
+		std::copy_n(&cur[(y + 1) * stride + 1], width, &walls[size_t(y) * width]);
+	}
+}
+
+void MazeGenerator::Connect(const Params& params, Grid& walls)
+{
+	const int width = params.width;
+	const int height = params.height;
+	const int nCells = width * height;
+	// union-find over the open cells: a run of open cells in a row hangs off
+	// its first cell, and runs touching the run above are joined to it
+	std::vector<int> parent(nCells);
+	auto find = [&parent](int i)
+	{
+		while (parent[i] != i)
+		{
+			parent[i] = parent[parent[i]];
+			i = parent[i];
+		}
+		return i;
+	};
+	auto unite = [&](int a, int b)
+	{
+		a = find(a);
+		b = find(b);
+		// the root is the group's first cell in row order
+		if (a != b)
+		{
+			parent[std::max(a, b)] = std::min(a, b);
+		}
+	};
+	for (int y = 0; y < height; y++)
+	{
+		int start = -1;
+		for (int x = 0; x < width; x++)
+		{
+			const int i = y * width + x;
+			parent[i] = i;
+			if (walls[i])
+			{
+				start = -1;
+				continue;
+			}
+			if (start < 0)
+			{
+				start = i;
+			}
+			parent[i] = start;
+			// once per stretch where the runs touch, the rest are joined already
+			if (y > 0 && !walls[i - width] && (i == start || walls[i - width - 1]))
+			{
+				unite(i, i - width);
+			}
+		}
+	}
+	// every other group gets a corridor to the first one: along the row of
+	// its first cell, then down the column of the first group's first cell
+	int first = -1;
+	for (int i = 0; i < nCells; i++)
+	{
+		if (walls[i] || find(i) != i)
+		{
+			continue;
+		}
+		if (first < 0)
+		{
+			first = i;
+			continue;
+		}
+		const int x0 = i % width;
+		const int y0 = i / width;
+		const int x1 = first % width;
+		const int y1 = first / width;
+		int prev = i;
+		auto carve = [&](int x, int y)
+		{
+			const int c = y * width + x;
+			walls[c] = 0;
+			unite(prev, c);
+			prev = c;
+		};
+		for (int x = x0; x != x1; x += x1 > x0 ? 1 : -1)
+		{
+			carve(x, y0);
+		}
+		for (int y = y0; y != y1; y += y1 > y0 ? 1 : -1)
+		{
+			carve(x1, y);
+		}
+		carve(x1, y1);
+	}
+}
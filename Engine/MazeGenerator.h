@@ -0,0 +1,53 @@
+#pragma once
+#include "Level.h"
+#include "ThreadPool.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Builds arenas as Levels from (seed, params): a recursive-division maze or
+// cellular-automaton caves. Afterwards every open cell is made reachable:
+// open cells are grouped with a union-find and each group is joined to the
+// first one by an L-shaped corridor. An arena depends only on its generator
+// and params, so Generate gives the same arenas for any thread count; the work
+// is one task per arena on a ThreadPool.
+class MazeGenerator
+{
+public:
+	enum class Style
+	{
+		division,	// walls splitting the board into rooms, one door per wall
+		caves		// random walls smoothed into open caverns
+	};
+	struct Params
+	{
+		int width;
+		int height;
+		Style style = Style::division;
+		int roomSize = 4;		// division: rooms this wide at least
+		int doorWidth = 1;
+		float fill = 0.45f;		// caves: share of walls before smoothing
+		int smoothSteps = 4;
+	};
+
+public:
+	MazeGenerator(int nThreads);
+	// "division" or "caves", false for anything else
+	static bool ParseStyle(const std::string& name, Style& style);
+	// count arenas from one seed, arena i from the i-th Split of Rng(seed);
+	// arena 0 is the one GenerateOne gives for that seed
+	std::vector<std::shared_ptr<Level>> Generate(const Params& params, uint64_t seed, int count);
+	static std::shared_ptr<Level> GenerateOne(const Params& params, uint64_t seed);
+
+private:
+	static std::shared_ptr<Level> Build(const Params& params, Rng rng);
+	// 1 = wall, row by row
+	typedef std::vector<unsigned char> Grid;
+	static void Divide(const Params& params, Rng& rng, Grid& walls);
+	static void Caves(const Params& params, Rng& rng, Grid& walls);
+	static void Connect(const Params& params, Grid& walls);
+
+private:
+	ThreadPool pool;
+};
@@ -0,0 +1,80 @@
+#include "MemoryPool.h"
+#include <algorithm>
+#include <cstdint>
+#include <new>
+
+MemoryPool::MemoryPool(size_t chunkBytes)
+	:
+	chunkBytes(std::max(chunkBytes, size_t(4096)))
+{
+}
+
+MemoryPool::~MemoryPool()
+{
+	while (pChunk != nullptr)
+	{
+		Chunk* pPrev = pChunk->pPrev;
+		::operator delete(pChunk);
+		pChunk = pPrev;
+	}
+}
+
+void* MemoryPool::Allocate(size_t bytes, size_t alignment)
+{
+	if (bytes == 0)
+	{
+		bytes = 1;
+	}
+	uintptr_t p = (uintptr_t(pNext) + alignment - 1) / alignment * alignment;
+	if (pChunk == nullptr || p + bytes > uintptr_t(pEnd))
+	{
+		NewChunk(bytes + alignment);
+		p = (uintptr_t(pNext) + alignment - 1) / alignment * alignment;
+	}
+	pNext = reinterpret_cast<char*>(p + bytes);
+	used += bytes;
+	peak = std::max(peak, used);
+	return reinterpret_cast<void*>(p);
+}
+
+void MemoryPool::Deallocate(void* p, size_t bytes)
+{
+	if (bytes == 0)
+	{
+		bytes = 1;
+	}
+	if (static_cast<char*>(p) + bytes == pNext)
+	{
+		pNext = static_cast<char*>(p);
+	}
+	used -= bytes;
+}
+
+size_t MemoryPool::GetUsed() const
+{
+	return used;
+}
+
+size_t MemoryPool::GetPeak() const
+{
+	return peak;
+}
+
+size_t MemoryPool::GetReserved() const
+{
+	return reserved;
+}
+
+void MemoryPool::NewChunk(size_t minBytes)
+{
+	// chunks double, so a pool that outgrows its first guess needs few of them
+	const size_t size = std::max(minBytes + sizeof(Chunk), pChunk == nullptr ? chunkBytes : 2 * pChunk->size);
+	// through operator new, so the allocation counter sees the pool growing
+	Chunk* pNew = static_cast<Chunk*>(::operator new(size));
+	pNew->pPrev = pChunk;
+	pNew->size = size;
+	pChunk = pNew;
+	pNext = reinterpret_cast<char*>(pNew + 1);
+	pEnd = reinterpret_cast<char*>(pNew) + size;
+	reserved += size;
+}
@@ -0,0 +1,89 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+// Monotonic memory for everything a game owns besides its GameState: tick
+// scratch, lookup tables, per-band maps. Allocations are carved from a few
+// large chunks, bumping a pointer; giving memory back only counts it, except
+// for the latest allocation, which is rolled back so a growing container can
+// reuse its old space. All of it is released at once when the pool goes, so
+// games coming and going leave no fragments on the heap.
+class MemoryPool
+{
+public:
+	MemoryPool(size_t chunkBytes = size_t(1) << 16);
+	MemoryPool(const MemoryPool&) = delete;
+	MemoryPool& operator=(const MemoryPool&) = delete;
+	~MemoryPool();
+	void* Allocate(size_t bytes, size_t alignment);
+	void Deallocate(void* p, size_t bytes);
+	// bytes handed out and not given back, now and at most so far
+	size_t GetUsed() const;
+	size_t GetPeak() const;
+	// bytes taken from the heap
+	size_t GetReserved() const;
+
+private:
+	struct Chunk
+	{
+		Chunk* pPrev;
+		size_t size;
+	};
+	void NewChunk(size_t minBytes);
+
+private:
+	size_t chunkBytes;
+	Chunk* pChunk = nullptr;	// the one being carved, older ones behind it
+	char* pNext = nullptr;
+	char* pEnd = nullptr;
+	size_t used = 0;
+	size_t peak = 0;
+	size_t reserved = 0;
+};
+
+// std allocator drawing from a MemoryPool
+template<typename T>
+class PoolAllocator
+{
+public:
+	typedef T value_type;
+
+public:
+	PoolAllocator(MemoryPool& pool)
+		:
+		pPool(&pool)
+	{}
+	template<typename U>
+	PoolAllocator(const PoolAllocator<U>& other)
+		:
+		pPool(other.GetPool())
+	{}
+	T* allocate(size_t n)
+	{
+		return static_cast<T*>(pPool->Allocate(n * sizeof(T), alignof(T)));
+	}
+	void deallocate(T* p, size_t n)
+	{
+		pPool->Deallocate(p, n * sizeof(T));
+	}
+	MemoryPool* GetPool() const
+	{
+		return pPool;
+	}
+	template<typename U>
+	bool operator==(const PoolAllocator<U>& other) const
+	{
+		return pPool == other.GetPool();
+	}
+	template<typename U>
+	bool operator!=(const PoolAllocator<U>& other) const
+	{
+		return pPool != other.GetPool();
+	}
+
+private:
+	MemoryPool* pPool;
+};
+
+template<typename T>
+using PoolVector = std::vector<T, PoolAllocator<T>>;
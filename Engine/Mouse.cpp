@@ -67,7 +67,7 @@ Mouse::Event Mouse::Read()
 
 void Mouse::Flush()
 {
-	buffer = std::queue<Event>();
+	buffer = decltype( buffer )();
 }
 
 void Mouse::OnMouseLeave()
@@ -19,6 +19,7 @@
  *	along with The Chili DirectX Framework.  If not, see <http://www.gnu.org/licenses/>.  *
  ******************************************************************************************/
 #pragma once
+#include "FixedRing.h"
 #include <queue>
 
 class Mouse
@@ -125,5 +126,6 @@ private:
 	bool leftIsPressed = false;
 	bool rightIsPressed = false;
 	bool isInWindow = false;
-	std::queue<Event> buffer;
+	// one slot over bufferSize for the push before a trim
+	std::queue<Event,FixedRing<Event,bufferSize + 1u>> buffer;
 };
\ No newline at end of file
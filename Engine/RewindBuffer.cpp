@@ -0,0 +1,304 @@
+#include "RewindBuffer.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+RewindBuffer::RewindBuffer(size_t budgetBytes, int keyframeInterval, size_t stateCapacity)
+	:
+	keyframeInterval(std::max(1, keyframeInterval))
+{
+	const size_t budgetWords = budgetBytes / sizeof(uint64_t);
+	latest.resize(std::min((stateCapacity + sizeof(uint64_t) - 1) / sizeof(uint64_t), budgetWords / 4));
+	delta.resize(budgetWords / 8);
+	entries.resize(std::max(size_t(2), budgetBytes / 16 / sizeof(Entry)));
+	ring.resize(budgetWords - latest.size() - delta.size() - entries.size() * sizeof(Entry) / sizeof(uint64_t));
+}
+
+void RewindBuffer::Record(const GameState& state, const TickWrites& writes)
+{
+	const uint64_t* pCur = static_cast<const uint64_t*>(state.GetData());
+	const size_t curWords = (state.GetUsed() + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+	if (curWords > latest.size())
+	{
+		Forget();
+		return;
+	}
+	// a block that shrank was replaced, its old tail has to be compared too;
+	// words past the end of the state count as zero on both sides
+	const bool isWhole = latestTick < 0 || writes.IsAll() || curWords < recordedWords;
+	deltaSize = 0;
+	deltaOverflow = false;
+	if (isWhole)
+	{
+		Diff(pCur, curWords, 0, std::max(curWords, recordedWords));
+	}
+	else
+	{
+		// the header, what was laid out since, and what the tick wrote
+		Diff(pCur, curWords, 0, std::min(size_t(2), curWords));
+		Diff(pCur, curWords, recordedWords, curWords);
+		for (const TickWrites::Range& r : writes)
+		{
+			const size_t end = (r.offset + r.bytes + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+			Diff(pCur, curWords, std::min(r.offset / sizeof(uint64_t), curWords), std::min(end, curWords));
+		}
+	}
+	recordedWords = curWords;
+	highWords = std::max(highWords, curWords);
+	latestTick++;
+
+	if (nEntries == entries.size())
+	{
+		PopOldest();
+	}
+	Entry e = { latestTick, tail, none, 0, none, 0 };
+	// the first record has no predecessor to lead from
+	if (latestTick > 0 && !deltaOverflow && Reserve(deltaSize, 0))
+	{
+		Store(delta, deltaSize, e.deltaPos);
+		e.deltaWords = deltaSize;
+		e.start = e.deltaPos;
+	}
+	else
+	{
+		// a broken chain: nothing before this tick can be rebuilt any more
+		while (nEntries > 0)
+		{
+			PopOldest();
+		}
+		head = tail = e.start = 0;
+	}
+	Entry& added = entries[(firstEntry + nEntries) % entries.size()];
+	added = e;
+	nEntries++;
+	if (latestTick % keyframeInterval == 0 && Reserve(curWords, 1))
+	{
+		Store(latest, curWords, added.keyPos);
+		added.keyWords = curWords;
+	}
+}
+
+size_t RewindBuffer::GetRecordedBytes() const
+{
+	return recordedWords * sizeof(uint64_t);
+}
+
+void RewindBuffer::Forget()
+{
+	// latest keeps the state it had, which the next whole compare starts from
+	while (nEntries > 0)
+	{
+		PopOldest();
+	}
+	head = tail = 0;
+	latestTick = -1;
+}
+
+void RewindBuffer::Diff(const uint64_t* pCur, size_t curWords, size_t begin, size_t end)
+{
+	for (size_t i = begin; i < end; )
+	{
+		// most of a block does not change from one tick to the next
+		if (i + 8 <= std::min(curWords, end) && memcmp(pCur + i, &latest[i], 8 * sizeof(uint64_t)) == 0)
+		{
+			i += 8;
+			continue;
+		}
+		const uint64_t word = i < curWords ? pCur[i] : 0;
+		if (word == latest[i])
+		{
+			i++;
+			continue;
+		}
+		const size_t start = i;
+		const size_t countPos = deltaSize + 1;
+		Put(start);
+		Put(0);
+		for (; i < end; i++)
+		{
+			const uint64_t w = i < curWords ? pCur[i] : 0;
+			if (w == latest[i])
+			{
+				break;
+			}
+			Put(w ^ latest[i]);
+			latest[i] = w;
+		}
+		if (!deltaOverflow)
+		{
+			delta[countPos] = i - start;
+		}
+	}
+}
+
+void RewindBuffer::Put(uint64_t word)
+{
+	// latest still has to follow the state, only the delta is lost
+	if (deltaSize < delta.size())
+	{
+		delta[deltaSize++] = word;
+	}
+	else
+	{
+		deltaOverflow = true;
+	}
+}
+
+int RewindBuffer::GetDepth() const
+{
+	if (nEntries == 0)
+	{
+		return 0;
+	}
+	// the oldest delta leads from the tick before it
+	const Entry& oldest = entries[firstEntry];
+	const long long first = oldest.deltaPos != none ? oldest.tick - 1 : oldest.tick;
+	return int(latestTick - first);
+}
+
+bool RewindBuffer::Reconstruct(int ticksBack, std::vector<uint64_t>& out) const
+{
+	if (ticksBack < 0 || ticksBack > GetDepth())
+	{
+		return false;
+	}
+	const long long target = latestTick - ticksBack;
+	// the latest state or the keyframes either side, whichever is closest
+	long long from = latestTick;
+	const Entry* pKey = nullptr;
+	const long long below = target - target % keyframeInterval;
+	for (long long k : { below, below + keyframeInterval })
+	{
+		const Entry* p = Find(k);
+		if (p != nullptr && p->keyPos != none && std::abs(k - target) < std::abs(from - target))
+		{
+			from = k;
+			pKey = p;
+		}
+	}
+	out.assign(highWords, 0);
+	if (pKey != nullptr)
+	{
+		std::copy_n(&ring[pKey->keyPos], pKey->keyWords, out.begin());
+	}
+	else
+	{
+		std::copy_n(latest.begin(), highWords, out.begin());
+	}
+	for (long long t = from; t > target; t--)
+	{
+		const Entry* p = Find(t);
+		ApplyDelta(&ring[p->deltaPos], p->deltaWords, out);
+	}
+	for (long long t = from + 1; t <= target; t++)
+	{
+		const Entry* p = Find(t);
+		ApplyDelta(&ring[p->deltaPos], p->deltaWords, out);
+	}
+	return true;
+}
+
+bool RewindBuffer::StepBack(int ticksBack, GameState& state)
+{
+	if (ticksBack < 0 || ticksBack > GetDepth())
+	{
+		return false;
+	}
+	for (int k = 0; k < ticksBack; k++)
+	{
+		// undo the newest delta on the latest state and drop its tick
+		const size_t last = (firstEntry + nEntries - 1) % entries.size();
+		const Entry& e = entries[last];
+		ApplyDelta(&ring[e.deltaPos], e.deltaWords, latest);
+		tail = e.start;
+		nEntries--;
+		latestTick--;
+	}
+	if (nEntries == 0)
+	{
+		head = tail = 0;
+	}
+	state.Restore(latest);
+	recordedWords = (state.GetUsed() + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+	return true;
+}
+
+bool RewindBuffer::Reserve(size_t n, size_t keep)
+{
+	// tail never catches up with head from below, so tail == head means empty
+	for (;;)
+	{
+		if (nEntries == 0)
+		{
+			head = tail = 0;
+			return n < ring.size();
+		}
+		if (tail >= head)
+		{
+			// free space is [tail, end) and [0, head)
+			if (tail + n <= ring.size())
+			{
+				return true;
+			}
+			if (n < head)
+			{
+				tail = 0;
+				return true;
+			}
+		}
+		else if (tail + n < head)
+		{
+			return true;
+		}
+		if (nEntries <= keep)
+		{
+			return false;
+		}
+		PopOldest();
+	}
+}
+
+void RewindBuffer::Store(const std::vector<uint64_t>& words, size_t n, size_t& pos)
+{
+	std::copy_n(words.begin(), n, ring.begin() + tail);
+	pos = tail;
+	tail += n;
+}
+
+void RewindBuffer::PopOldest()
+{
+	firstEntry = (firstEntry + 1) % entries.size();
+	nEntries--;
+	if (nEntries > 0)
+	{
+		head = entries[firstEntry].start;
+	}
+}
+
+const RewindBuffer::Entry* RewindBuffer::Find(long long tick) const
+{
+	if (nEntries == 0)
+	{
+		return nullptr;
+	}
+	const long long first = entries[firstEntry].tick;
+	if (tick < first || tick > latestTick)
+	{
+		return nullptr;
+	}
+	return &entries[(firstEntry + size_t(tick - first)) % entries.size()];
+}
+
+void RewindBuffer::ApplyDelta(const uint64_t* pDelta, size_t nWords, std::vector<uint64_t>& words)
+{
+	for (size_t i = 0; i < nWords; )
+	{
+		const size_t offset = size_t(pDelta[i]);
+		const size_t count = size_t(pDelta[i + 1]);
+		for (size_t k = 0; k < count; k++)
+		{
+			words[offset + k] ^= pDelta[i + 2 + k];
+		}
+		i += 2 + count;
+	}
+}
@@ -0,0 +1,82 @@
+#pragma once
+#include "GameState.h"
+#include "TickWrites.h"
+#include <cstddef>
+#include <cstdint>
+#include <climits>
+#include <vector>
+
+// The last ticks of a game, for stepping back in time. After every tick
+// Record stores the words of the GameState block that changed, XORed with
+// their old value, so one delta leads from tick t - 1 to t and, applied
+// again, back. Only the ranges the tick wrote are compared, as the parts of
+// the state name them from the tick's ChangeJournal (see TickWrites), so
+// recording costs what the tick changed, not the size of the state. Every
+// keyframeInterval ticks the whole block is stored as well. A tick is rebuilt
+// from whichever is closer, the latest state or a keyframe, applying the
+// deltas in between: time follows that distance.
+// Everything is taken from budgetBytes up front and never grows: a quarter
+// for the copy of the latest state, an eighth for the delta being built, a
+// sixteenth for the tick entries, the rest for the ring that deltas and
+// keyframes share. The oldest ticks make way for new ones; a delta too big
+// for its scratch breaks the chain, and a state outgrowing its copy is no
+// longer recorded at all.
+class RewindBuffer
+{
+public:
+	// stateCapacity bounds the copy of the latest state, see GameState::GetCapacity
+	RewindBuffer(size_t budgetBytes, int keyframeInterval, size_t stateCapacity);
+	// stores state as the next tick, comparing what writes names and the
+	// bytes laid out since the last record; the first record compares everything
+	void Record(const GameState& state, const TickWrites& writes);
+	// bytes of the state at the last record, from where new allocations go
+	size_t GetRecordedBytes() const;
+	// how many ticks back can be rebuilt
+	int GetDepth() const;
+	// the block as it was ticksBack ticks before the latest record, in the
+	// format of GameState::Snapshot; false if that is no longer held
+	bool Reconstruct(int ticksBack, std::vector<uint64_t>& out) const;
+	// puts state back ticksBack ticks and forgets the ticks after, so
+	// recording carries on from there
+	bool StepBack(int ticksBack, GameState& state);
+
+private:
+	static constexpr size_t none = SIZE_MAX;
+	struct Entry
+	{
+		long long tick;
+		size_t start;		// where its words begin in the ring
+		size_t deltaPos;	// runs of { word offset, count, count XOR words }, none = chain start
+		size_t deltaWords;
+		size_t keyPos;		// none = no keyframe
+		size_t keyWords;
+	};
+	// room for n contiguous words at the write position, evicting old ticks
+	// but keeping the newest keep of them
+	bool Reserve(size_t n, size_t keep);
+	void Store(const std::vector<uint64_t>& words, size_t n, size_t& pos);
+	void Forget();
+	void PopOldest();
+	// appends runs for the words in [begin, end) that differ from latest and updates latest
+	void Diff(const uint64_t* pCur, size_t curWords, size_t begin, size_t end);
+	void Put(uint64_t word);
+	const Entry* Find(long long tick) const;
+	static void ApplyDelta(const uint64_t* pDelta, size_t nWords, std::vector<uint64_t>& words);
+
+private:
+	const int keyframeInterval;
+	std::vector<uint64_t> ring;
+	size_t head = 0;	// start of the oldest entry
+	size_t tail = 0;	// where the next words go
+	// one entry per tick, oldest first, in a ring of their own
+	std::vector<Entry> entries;
+	size_t firstEntry = 0;
+	size_t nEntries = 0;
+	std::vector<uint64_t> latest;	// the block at the last record, zero past its end
+	long long latestTick = -1;
+	size_t recordedWords = 0;	// block size at the last record
+	size_t highWords = 0;		// largest block size recorded, what deltas reach
+	std::vector<uint64_t> delta;
+	size_t deltaSize = 0;
+	bool deltaOverflow = false;
+};
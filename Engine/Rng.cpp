@@ -0,0 +1,52 @@
+#include "Rng.h"
+
+Rng::Rng(uint64_t seed, uint64_t stream)
+{
+	// the stream is hashed into the seed; SplitMix spreads the pair over the
+	// state, which can then never be all zero
+	uint64_t h = stream;
+	uint64_t x = seed ^ SplitMix(h);
+	for (uint64_t& w : s)
+	{
+		w = SplitMix(x);
+	}
+}
+
+Rng Rng::Split()
+{
+	const Rng part = *this;
+	Jump();
+	return part;
+}
+
+uint64_t Rng::SplitMix(uint64_t& x)
+{
+	uint64_t z = (x += 0x9e3779b97f4a7c15);
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+	return z ^ (z >> 31);
+}
+
+void Rng::Jump()
+{
+	static const uint64_t jump[] = { 0x180ec6d33cfd0aba, 0xd5a61266f0c9392c, 0xa9582618e03fc9aa, 0x39abdc4529b1661c };
+	uint64_t t[4] = {};
+	for (uint64_t word : jump)
+	{
+		for (int b = 0; b < 64; b++)
+		{
+			if (word & (uint64_t(1) << b))
+			{
+				for (int i = 0; i < 4; i++)
+				{
+					t[i] ^= s[i];
+				}
+			}
+			(*this)();
+		}
+	}
+	for (int i = 0; i < 4; i++)
+	{
+		s[i] = t[i];
+	}
+}
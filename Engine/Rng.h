@@ -0,0 +1,78 @@
+#pragma once
+#include <cstdint>
+
+// The engine's random number generator: xoshiro256** with 32 bytes of state,
+// so a game that is copied copies its stream for free. Rng(seed, stream)
+// gives each (seed, stream) pair its own reproducible sequence, and Split
+// hands out generators 2^128 draws apart for work that must not overlap.
+// It is a UniformRandomBitGenerator, std distributions accept it.
+class Rng
+{
+public:
+	typedef uint64_t result_type;
+
+public:
+	Rng(uint64_t seed = 0, uint64_t stream = 0);
+	static constexpr result_type min()
+	{
+		return 0;
+	}
+	static constexpr result_type max()
+	{
+		return UINT64_MAX;
+	}
+	result_type operator()()
+	{
+		const uint64_t result = Rotl(s[1] * 5, 7) * 9;
+		const uint64_t t = s[1] << 17;
+		s[2] ^= s[0];
+		s[3] ^= s[1];
+		s[1] ^= s[2];
+		s[0] ^= s[3];
+		s[2] ^= t;
+		s[3] = Rotl(s[3], 45);
+		return result;
+	}
+	// uniform in [0, n), n > 0: one multiply, a division only on the rare reject
+	uint32_t Below(uint32_t n)
+	{
+		uint64_t m = ((*this)() >> 32) * n;
+		if (uint32_t(m) < n)
+		{
+			const uint32_t threshold = (0u - n) % n;
+			while (uint32_t(m) < threshold)
+			{
+				m = ((*this)() >> 32) * n;
+			}
+		}
+		return uint32_t(m >> 32);
+	}
+	// the same for n past 32 bits, by rejection and a division
+	uint64_t BelowWide(uint64_t n)
+	{
+		if (n <= UINT32_MAX)
+		{
+			return Below(uint32_t(n));
+		}
+		const uint64_t threshold = (0 - n) % n;
+		uint64_t r = (*this)();
+		while (r < threshold)
+		{
+			r = (*this)();
+		}
+		return r % n;
+	}
+	// this generator as it is, while this one moves on 2^128 draws
+	Rng Split();
+
+private:
+	static uint64_t Rotl(uint64_t x, int k)
+	{
+		return (x << k) | (x >> (64 - k));
+	}
+	static uint64_t SplitMix(uint64_t& x);
+	void Jump();
+
+private:
+	uint64_t s[4];
+};
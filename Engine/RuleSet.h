@@ -0,0 +1,14 @@
+#pragma once
+#include "BoardShapes.h"
+
+// The rules a game plays by, as one compile-time policy for Arena's tick: the
+// board shape plus the optional rules switched in data.txt. Every switch is a
+// constant in the instantiation, so a rule that is off costs nothing per move.
+template<class Shape_, bool poisonSpeedup_, bool barrierOnEat_, bool jumps_>
+struct RuleSet
+{
+	typedef Shape_ Shape;
+	static constexpr bool poisonSpeedup = poisonSpeedup_;	// poison shortens the move period
+	static constexpr bool barrierOnEat = barrierOnEat_;	// each food eaten adds a barrier
+	static constexpr bool jumps = jumps_;			// JumpOn takes effect
+};
@@ -0,0 +1,251 @@
+#include "SnakeBodies.h"
+
+SnakeBodies::SnakeBodies(GameState& state, int nSnakes, const Topology& topology, MemoryPool& memory, bool logFrees)
+	:
+	state(state),
+	topology(topology),
+	nSnakes(nSnakes),
+	headLoc(state.New<Location>(nSnakes)),
+	tailLoc(state.New<Location>(nSnakes)),
+	length(state.New<int>(nSnakes)),
+	frontBlock(state.New<size_t>(nSnakes)),
+	frontFill(state.New<int>(nSnakes)),
+	backBlock(state.New<size_t>(nSnakes)),
+	backPos(state.New<int>(nSnakes)),
+	freeBlocks(*state.New<size_t>(1)),
+	logFrees(logFrees),
+	freed(PoolAllocator<size_t>(memory))
+{
+	if (logFrees)
+	{
+		freed.reserve(2 * size_t(nSnakes) + 64);
+	}
+}
+
+size_t SnakeBodies::StateBytes(int nSnakes, long long maxLinks)
+{
+	// every body has at most one part-filled block at each end, and every
+	// block may carry a stride block
+	const size_t nBlocks = 2 * (size_t(maxLinks / blockLinks) + 2 * size_t(nSnakes));
+	return 2 * GameState::Bound<Location>(nSnakes) + 3 * GameState::Bound<int>(nSnakes)
+		+ 2 * GameState::Bound<size_t>(nSnakes) + GameState::Bound<size_t>(1)
+		+ nBlocks * GameState::Bound<Block>(1);
+}
+
+void SnakeBodies::Start(int id, const Location& loc)
+{
+	Clear(id);
+	headLoc[id] = loc;
+	tailLoc[id] = loc;
+	length[id] = 1;
+}
+
+void SnakeBodies::Clear(int id)
+{
+	for (size_t b = backBlock[id]; b != 0; )
+	{
+		const size_t n = GetBlock(b)->next;
+		FreeBlock(b);
+		b = n;
+	}
+	frontBlock[id] = 0;
+	frontFill[id] = 0;
+	backBlock[id] = 0;
+	backPos[id] = 0;
+	length[id] = 0;
+}
+
+bool SnakeBodies::IsIntact() const
+{
+	// a chain longer than the pool can hold has a loop in it
+	const size_t maxBlocks = state.GetUsed() / sizeof(Block);
+	const auto onBoard = [this](const Location& loc)
+	{
+		return loc.x >= 0 && loc.x < topology.GetWidth() && loc.y >= 0 && loc.y < topology.GetHeight();
+	};
+	size_t n = 0;
+	for (size_t b = freeBlocks; b != 0; b = GetBlock(b)->next)
+	{
+		if (!IsBlock(b) || ++n > maxBlocks)
+		{
+			return false;
+		}
+	}
+	for (int id = 0; id < nSnakes; id++)
+	{
+		if (length[id] == 0)
+		{
+			continue;
+		}
+		if (length[id] < 0 || !onBoard(headLoc[id]) || !onBoard(tailLoc[id]))
+		{
+			return false;
+		}
+		if (length[id] == 1)
+		{
+			continue;
+		}
+		if (frontFill[id] < 1 || frontFill[id] > blockLinks || backPos[id] < 0 || backPos[id] >= blockLinks)
+		{
+			return false;
+		}
+		n = 0;
+		for (size_t b = backBlock[id];; b = GetBlock(b)->next)
+		{
+			if (!IsBlock(b) || ++n > maxBlocks || (GetBlock(b)->strides != 0 && !IsBlock(GetBlock(b)->strides)))
+			{
+				return false;
+			}
+			if (b == frontBlock[id])
+			{
+				break;
+			}
+		}
+	}
+	return true;
+}
+
+bool SnakeBodies::IsBlock(size_t b) const
+{
+	// blocks come after the free list head
+	const size_t firstBlock = size_t(reinterpret_cast<const char*>(&freeBlocks + 1) - static_cast<const char*>(state.GetData()));
+	return b >= firstBlock && b % alignof(Block) == 0 && b <= state.GetUsed() && state.GetUsed() - b >= sizeof(Block);
+}
+
+Location SnakeBodies::GetNeck(int id) const
+{
+	assert(length[id] > 1);
+	const Block& front = *GetBlock(frontBlock[id]);
+	const int i = frontFill[id] - 1;
+	return topology.Retreat(headLoc[id], GetLink(front, i), GetStride(front, i));
+}
+
+void SnakeBodies::PushLink(int id, int dir, int stride)
+{
+	assert(length[id] > 0 && stride >= 1 && stride <= Topology::maxStride);
+	if (frontBlock[id] == 0 || frontFill[id] == blockLinks)
+	{
+		const size_t b = NewBlock();
+		if (frontBlock[id] == 0)
+		{
+			backBlock[id] = b;
+			backPos[id] = 0;
+		}
+		else
+		{
+			GetBlock(frontBlock[id])->next = b;
+			GetBlock(b)->prev = frontBlock[id];
+		}
+		frontBlock[id] = b;
+		frontFill[id] = 0;
+	}
+	Block& front = *GetBlock(frontBlock[id]);
+	const int i = frontFill[id]++;
+	SetLink(front, i, dir);
+	if (stride != 1 && front.strides == 0)
+	{
+		// links before i are all stride 1, which a zeroed block says already
+		front.strides = NewBlock();
+	}
+	if (front.strides != 0)
+	{
+		SetLink(*GetBlock(front.strides), i, stride - 1);
+	}
+	length[id]++;
+}
+
+int SnakeBodies::PopLink(int id, int& stride)
+{
+	assert(length[id] > 1);
+	// the oldest link leads from the tail to the next segment
+	const Block& back = *GetBlock(backBlock[id]);
+	const int dir = GetLink(back, backPos[id]);
+	stride = GetStride(back, backPos[id]);
+	backPos[id]++;
+	length[id]--;
+	if (length[id] == 1)
+	{
+		FreeBlock(backBlock[id]);
+		frontBlock[id] = 0;
+		frontFill[id] = 0;
+		backBlock[id] = 0;
+		backPos[id] = 0;
+	}
+	else if (backPos[id] == blockLinks)
+	{
+		const size_t b = back.next;
+		FreeBlock(backBlock[id]);
+		GetBlock(b)->prev = 0;
+		backBlock[id] = b;
+		backPos[id] = 0;
+	}
+	return dir;
+}
+
+size_t SnakeBodies::NewBlock()
+{
+	size_t b = freeBlocks;
+	if (b != 0)
+	{
+		freeBlocks = GetBlock(b)->next;
+		*GetBlock(b) = Block();
+	}
+	else
+	{
+		b = state.Allocate<Block>(1);
+	}
+	return b;
+}
+
+void SnakeBodies::FreeBlock(size_t b)
+{
+	Block& block = *GetBlock(b);
+	if (block.strides != 0)
+	{
+		FreeBlock(block.strides);
+		block.strides = 0;
+	}
+	block.next = freeBlocks;
+	freeBlocks = b;
+	if (logFrees)
+	{
+		freed.push_back(b);
+	}
+}
+
+void SnakeBodies::AddTickWrites(const ChangeJournal& journal, TickWrites& writes)
+{
+	for (const ChangeJournal::Record& r : journal)
+	{
+		if (r.kind == ChangeJournal::Kind::head && frontBlock[r.id] != 0)
+		{
+			// the link went into the front block; a new front block was linked
+			// from the one before it
+			AddBlockWrites(frontBlock[r.id], writes);
+			AddBlockWrites(GetBlock(frontBlock[r.id])->prev, writes);
+		}
+		else if (r.kind == ChangeJournal::Kind::tail)
+		{
+			// a back block left behind is freed, the next one forgets it
+			AddBlockWrites(backBlock[r.id], writes);
+		}
+	}
+	// freed by tails, crashes and removals, and maybe taken again since
+	for (size_t b : freed)
+	{
+		AddBlockWrites(b, writes);
+	}
+	freed.clear();
+}
+
+void SnakeBodies::AddBlockWrites(size_t b, TickWrites& writes) const
+{
+	if (b != 0)
+	{
+		writes.Add(b, sizeof(Block));
+		if (GetBlock(b)->strides != 0)
+		{
+			writes.Add(GetBlock(b)->strides, sizeof(Block));
+		}
+	}
+}
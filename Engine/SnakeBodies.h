@@ -0,0 +1,168 @@
+#pragma once
+#include "Location.h"
+#include "Topology.h"
+#include "BoardShapes.h"
+#include "GameState.h"
+#include "ChangeJournal.h"
+#include "MemoryPool.h"
+#include "TickWrites.h"
+#include <assert.h>
+#include <cstdint>
+
+// The bodies of all snakes of an Arena. A body is its head and tail cell plus,
+// for every link between two segments, the 2-bit direction of the step from
+// the tail side to the head side. Directions are packed into blocks of
+// blockLinks links drawn from one pool; a snake is a chain of blocks, so
+// pushing a head and popping a tail are O(1) and a segment costs ~2 bits
+// whatever the length. Links longer than one cell (jumps) are rare; a block
+// holding one gets a second block with the 2-bit stride - 1 of its links.
+// Where a link leads is up to the Topology, which walks it either way.
+// Everything lives in the GameState; blocks are referred to by offset.
+// With logFrees the blocks freed since the last AddTickWrites are kept aside
+// (in memory, not the state), since a freed block is in no body to find it by.
+class SnakeBodies
+{
+public:
+	static constexpr int blockLinks = 256;
+
+public:
+	SnakeBodies(GameState& state, int nSnakes, const Topology& topology, MemoryPool& memory, bool logFrees);
+	// state bytes for nSnakes bodies of maxLinks links in all
+	static size_t StateBytes(int nSnakes, long long maxLinks);
+	// a body of one segment at loc
+	void Start(int id, const Location& loc);
+	void Clear(int id);
+	int GetLength(int id) const
+	{
+		return length[id];
+	}
+	const Location& GetHead(int id) const
+	{
+		return headLoc[id];
+	}
+	const Location& GetTail(int id) const
+	{
+		return tailLoc[id];
+	}
+	// whether every body and the free list are chains of whole blocks inside
+	// the bytes in use, with ends on the board, for a block read from a file
+	bool IsIntact() const;
+	// the blocks the head and tail records of journal and the blocks freed
+	// since the last call may have written; starts the next log of freed blocks
+	void AddTickWrites(const ChangeJournal& journal, TickWrites& writes);
+	// segment 1, only for bodies of two or more segments
+	Location GetNeck(int id) const;
+	// the head moves stride cells along dir, which the topology must allow;
+	// the old head becomes segment 1. Shape is the tick's move policy.
+	template<class Shape = AnyShape>
+	void PushHead(int id, int dir, int stride)
+	{
+		PushLink(id, dir, stride);
+		Shape::Advance(topology, headLoc[id], dir, stride, headLoc[id]);
+	}
+	template<class Shape = AnyShape>
+	void PopTail(int id)
+	{
+		int stride;
+		const int dir = PopLink(id, stride);
+		Shape::Advance(topology, tailLoc[id], dir, stride, tailLoc[id]);
+	}
+	// calls f(k, loc) for every segment, k = 0 at the head. Links are read one
+	// 64-bit word (32 links) at a time.
+	template<typename F>
+	void ForEach(int id, F f) const
+	{
+		Location loc = headLoc[id];
+		f(0, loc);
+		if (length[id] < 2)
+		{
+			return;
+		}
+		const Block* pBlock = GetBlock(frontBlock[id]);
+		const Block* pStrides = StridesOf(*pBlock);
+		int i = frontFill[id];
+		uint64_t word = 0;
+		uint64_t strideWord = 0;
+		for (int k = 1; k < length[id]; k++)
+		{
+			if (i == 0)
+			{
+				pBlock = GetBlock(pBlock->prev);
+				pStrides = StridesOf(*pBlock);
+				i = blockLinks;
+			}
+			i--;
+			if (k == 1 || i % 32 == 31)
+			{
+				word = pBlock->bits[i / 32];
+				strideWord = pStrides != nullptr ? pStrides->bits[i / 32] : 0;
+			}
+			const int shift = 2 * (i % 32);
+			const int dir = int(word >> shift) & 3;
+			const int stride = 1 + (int(strideWord >> shift) & 3);
+			loc = topology.Retreat(loc, dir, stride);
+			f(k, loc);
+		}
+	}
+
+private:
+	static constexpr int blockWords = blockLinks / 32;
+	static_assert(Topology::maxStride <= 4, "strides are stored in 2 bits");
+	struct Block
+	{
+		uint64_t bits[blockWords];
+		size_t next;	// newer block of the chain, or next free block
+		size_t prev;	// older block
+		size_t strides;	// block with the strides of these links, 0 = all 1
+	};
+	Block* GetBlock(size_t b) const
+	{
+		return state.Get<Block>(b);
+	}
+	static int GetLink(const Block& block, int i)
+	{
+		return int(block.bits[i / 32] >> (2 * (i % 32))) & 3;
+	}
+	static void SetLink(Block& block, int i, int value)
+	{
+		uint64_t& word = block.bits[i / 32];
+		word = (word & ~(uint64_t(3) << (2 * (i % 32)))) | (uint64_t(value) << (2 * (i % 32)));
+	}
+	const Block* StridesOf(const Block& block) const
+	{
+		return block.strides != 0 ? GetBlock(block.strides) : nullptr;
+	}
+	int GetStride(const Block& block, int i) const
+	{
+		return block.strides != 0 ? 1 + GetLink(*GetBlock(block.strides), i) : 1;
+	}
+	void PushLink(int id, int dir, int stride);
+	// drops the oldest link, returns its dir and stride
+	int PopLink(int id, int& stride);
+	size_t NewBlock();
+	void FreeBlock(size_t b);
+	// a whole block of the pool inside the bytes in use
+	bool IsBlock(size_t b) const;
+	// block b, if any, and its strides block
+	void AddBlockWrites(size_t b, TickWrites& writes) const;
+
+private:
+	GameState& state;
+	const Topology& topology;
+	const int nSnakes;
+
+	// per snake; links are appended at frontFill of frontBlock and consumed
+	// from backPos of backBlock (offsets, 0 = no block)
+	Location* headLoc;
+	Location* tailLoc;
+	int* length;
+	size_t* frontBlock;
+	int* frontFill;
+	size_t* backBlock;
+	int* backPos;
+
+	// block pool, blocks chained from older (back) to newer (front)
+	size_t& freeBlocks;	// first free block, 0 = none
+	const bool logFrees;
+	PoolVector<size_t> freed;
+};
@@ -0,0 +1,113 @@
+#include "SpawnWeights.h"
+#include <algorithm>
+#include <assert.h>
+#include <cstdlib>
+
+SpawnWeights::SpawnWeights(GameState& state, int width, int height, Shape shape)
+	:
+	width(width),
+	height(height),
+	shape(shape),
+	nCells(size_t(width) * height),
+	pState(&state)
+{
+	if (shape == Shape::uniform)
+	{
+		return;
+	}
+	// the total weight must fit Rng::Below
+	assert(nCells * maxWeight <= UINT32_MAX);
+	maxDistance = std::max(1ll, std::max((long long)(width - 1) * height, (long long)(height - 1) * width));
+	topStep = 1;
+	while (2 * topStep <= nCells)
+	{
+		topStep *= 2;
+	}
+	tree = state.New<uint32_t>(nCells + 1);
+	// every cell starts out free; a linear build instead of nCells Adds
+	for (size_t k = 1; k <= nCells; k++)
+	{
+		const uint32_t w = GetWeight(int((k - 1) % width), int((k - 1) / width));
+		tree[k] += w;
+		tree[0] += w;
+		const size_t parent = k + (k & (0 - k));
+		if (parent <= nCells)
+		{
+			tree[parent] += tree[k];
+		}
+	}
+}
+
+size_t SpawnWeights::StateBytes(int width, int height, Shape shape)
+{
+	return shape == Shape::uniform ? 0 : GameState::Bound<uint32_t>(size_t(width) * height + 1);
+}
+
+SpawnWeights::Shape SpawnWeights::ParseShape(const std::string& name)
+{
+	if (name == "centre")
+	{
+		return Shape::centre;
+	}
+	if (name == "edges")
+	{
+		return Shape::edges;
+	}
+	return Shape::uniform;
+}
+
+bool SpawnWeights::IsUniform() const
+{
+	return shape == Shape::uniform;
+}
+
+uint32_t SpawnWeights::GetWeight(int x, int y) const
+{
+	if (shape == Shape::uniform)
+	{
+		return 1;
+	}
+	// distance from the centre, scaled so both axes span the same range
+	const long long d = std::max((long long)std::abs(2 * x - (width - 1)) * height,
+		(long long)std::abs(2 * y - (height - 1)) * width);
+	const long long toCentre = std::min(d, maxDistance);
+	const long long fromCentre = shape == Shape::centre ? maxDistance - toCentre : toCentre;
+	return 1 + uint32_t((maxWeight - 1) * fromCentre / maxDistance);
+}
+
+bool SpawnWeights::Sample(Rng& rng, int& x, int& y) const
+{
+	assert(shape != Shape::uniform);
+	if (tree[0] == 0)
+	{
+		return false;
+	}
+	// descend to the first cell whose prefix sum passes r
+	uint32_t r = rng.Below(tree[0]);
+	size_t pos = 0;
+	for (size_t step = topStep; step > 0; step /= 2)
+	{
+		if (pos + step <= nCells && tree[pos + step] <= r)
+		{
+			pos += step;
+			r -= tree[pos];
+		}
+	}
+	x = int(pos % width);
+	y = int(pos / width);
+	return true;
+}
+
+void SpawnWeights::AddCellWrites(int x, int y, TickWrites& writes) const
+{
+	if (shape == Shape::uniform)
+	{
+		return;
+	}
+	// the cells Add walks
+	writes.Add(pState->OffsetOf(tree), sizeof(uint32_t));
+	for (size_t k = size_t(y) * width + x + 1; k <= nCells; k += k & (0 - k))
+	{
+		writes.Add(pState->OffsetOf(&tree[k]), sizeof(uint32_t));
+	}
+}
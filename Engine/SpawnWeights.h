@@ -0,0 +1,67 @@
+#pragma once
+#include "GameState.h"
+#include "Rng.h"
+#include "TickWrites.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Where items of one kind spawn: every cell has a weight, from a shape named
+// in the config, and a free cell is drawn with probability proportional to
+// its weight. The weights of the free cells sit in a Fenwick tree in the
+// GameState, so a draw and a cell filling or emptying each cost O(log cells)
+// and snapshots carry the tree along. The uniform shape keeps no tree, Board
+// then draws by rejection as before.
+class SpawnWeights
+{
+public:
+	enum class Shape
+	{
+		uniform,
+		centre,	// heaviest in the middle of the board
+		edges	// heaviest along the border
+	};
+	static constexpr uint32_t maxWeight = 16;
+
+public:
+	SpawnWeights(GameState& state, int width, int height, Shape shape);
+	static size_t StateBytes(int width, int height, Shape shape);
+	// "centre", "edges", anything else is uniform
+	static Shape ParseShape(const std::string& name);
+	bool IsUniform() const;
+	uint32_t GetWeight(int x, int y) const;
+	// cell (x, y) became free or stopped being free
+	void Free(int x, int y)
+	{
+		Add(size_t(y) * width + x, GetWeight(x, y));
+	}
+	void Take(int x, int y)
+	{
+		Add(size_t(y) * width + x, 0u - GetWeight(x, y));
+	}
+	// the sums a change to cell (x, y) wrote
+	void AddCellWrites(int x, int y, TickWrites& writes) const;
+	// a free cell, by weight; false if no cell is free
+	bool Sample(Rng& rng, int& x, int& y) const;
+
+private:
+	void Add(size_t i, uint32_t delta)
+	{
+		// sums wrap like the weights they hold, so a negative delta is 0 - w
+		tree[0] += delta;
+		for (size_t k = i + 1; k <= nCells; k += k & (0 - k))
+		{
+			tree[k] += delta;
+		}
+	}
+
+private:
+	int width;
+	int height;
+	Shape shape;
+	size_t nCells;
+	size_t topStep = 0;			// largest power of two <= nCells
+	long long maxDistance = 1;
+	const GameState* pState;
+	uint32_t* tree = nullptr;	// [0] total, [1..nCells] Fenwick sums
+};
@@ -0,0 +1,87 @@
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(int nThreads)
+{
+	for (int i = 1; i < nThreads; i++)
+	{
+		workers.emplace_back(&ThreadPool::WorkLoop, this);
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+		quit = true;
+	}
+	wake.notify_all();
+	for (std::thread& t : workers)
+	{
+		t.join();
+	}
+}
+
+int ThreadPool::GetThreadCount() const
+{
+	return int(workers.size()) + 1;
+}
+
+void ThreadPool::Run(int nTasks_in, TaskFn fn_in, void* pTask_in)
+{
+	if (workers.empty() || nTasks_in <= 1)
+	{
+		for (int i = 0; i < nTasks_in; i++)
+		{
+			fn_in(pTask_in, i);
+		}
+		return;
+	}
+	{
+		// a worker that woke late may still be draining the previous loop
+		std::unique_lock<std::mutex> lock(mtx);
+		done.wait(lock, [this] { return busy == 0; });
+		fn = fn_in;
+		pTask = pTask_in;
+		nTasks = nTasks_in;
+		next = 0;
+		remaining = nTasks_in;
+		generation++;
+	}
+	wake.notify_all();
+	Drain();
+	std::unique_lock<std::mutex> lock(mtx);
+	done.wait(lock, [this] { return remaining == 0 && busy == 0; });
+}
+
+void ThreadPool::WorkLoop()
+{
+	unsigned int seen = 0;
+	for (;;)
+	{
+		{
+			std::unique_lock<std::mutex> lock(mtx);
+			wake.wait(lock, [&] { return quit || generation != seen; });
+			if (quit)
+			{
+				return;
+			}
+			seen = generation;
+			busy++;
+		}
+		Drain();
+		{
+			std::lock_guard<std::mutex> lock(mtx);
+			busy--;
+		}
+		done.notify_all();
+	}
+}
+
+void ThreadPool::Drain()
+{
+	for (int i = next++; i < nTasks; i = next++)
+	{
+		fn(pTask, i);
+		remaining--;
+	}
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads for fork-join loops. ParallelFor hands out task
+// indices 0..nTasks-1 to the workers and the calling thread, and returns once
+// all of them ran. No allocation per call; with one thread it runs inline.
+class ThreadPool
+{
+public:
+	ThreadPool(int nThreads);
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+	~ThreadPool();
+	int GetThreadCount() const;
+	template<typename F>
+	void ParallelFor(int nTasks, F& task)
+	{
+		Run(nTasks, [](void* pTask, int i) { (*static_cast<F*>(pTask))(i); }, &task);
+	}
+
+private:
+	typedef void (*TaskFn)(void*, int);
+	void Run(int nTasks, TaskFn fn, void* pTask);
+	void WorkLoop();
+	void Drain();
+
+private:
+	std::vector<std::thread> workers;
+	std::mutex mtx;
+	std::condition_variable wake;
+	std::condition_variable done;
+	unsigned int generation = 0;
+	int busy = 0;				// workers inside Drain
+	bool quit = false;
+	TaskFn fn = nullptr;
+	void* pTask = nullptr;
+	int nTasks = 0;
+	std::atomic<int> next{ 0 };
+	std::atomic<int> remaining{ 0 };
+};
@@ -0,0 +1,59 @@
+#pragma once
+#include "MemoryPool.h"
+#include <cstddef>
+
+// The byte ranges of a GameState one tick may have written, for RewindBuffer
+// to compare against its copy instead of the whole block. Each part of the
+// state adds its own from the tick's ChangeJournal records (the cells that
+// changed, heads added, tails removed, snakes gone) and what it keeps for
+// itself (the per-snake fields, scores and move periods among them). A range
+// too many only costs a compare, one too few loses a change, so owners err
+// on the side of more. Ranges may overlap and come in any order.
+class TickWrites
+{
+public:
+	struct Range
+	{
+		size_t offset;
+		size_t bytes;
+	};
+
+public:
+	TickWrites(MemoryPool& memory, size_t reserve)
+		:
+		ranges(PoolAllocator<Range>(memory))
+	{
+		ranges.reserve(reserve);
+	}
+	void Add(size_t offset, size_t bytes)
+	{
+		ranges.push_back({ offset, bytes });
+	}
+	// everything counts as written: the state is new or was replaced
+	void AddAll()
+	{
+		isAll = true;
+	}
+	bool IsAll() const
+	{
+		return isAll;
+	}
+	// keeps the memory, so steady ticks add without allocating
+	void Clear()
+	{
+		ranges.clear();
+		isAll = false;
+	}
+	const Range* begin() const
+	{
+		return ranges.data();
+	}
+	const Range* end() const
+	{
+		return ranges.data() + ranges.size();
+	}
+
+private:
+	bool isAll = false;
+	PoolVector<Range> ranges;
+};
@@ -0,0 +1,213 @@
+#include "TimingWheel.h"
+#include "BitBoard.h"
+#include <algorithm>
+#include <assert.h>
+
+TimingWheel::TimingWheel(GameState& state, int nEvents)
+	:
+	nEvents(nEvents),
+	nodes(state.New<Node>(nEvents)),
+	heads(state.New<int>(nLevels * nSlots)),
+	occupied(state.New<uint64_t>(nLevels)),
+	pNow(state.New<uint64_t>(1))
+{
+}
+
+size_t TimingWheel::StateBytes(int nEvents)
+{
+	return GameState::Bound<Node>(nEvents) + GameState::Bound<int>(nLevels * nSlots)
+		+ GameState::Bound<uint64_t>(nLevels) + GameState::Bound<uint64_t>(1);
+}
+
+void TimingWheel::Schedule(int id, uint64_t time)
+{
+	assert(id >= 0 && id < nEvents);
+	Unlink(id);
+	nodes[id].time = std::max(time, *pNow);
+	Insert(id);
+}
+
+void TimingWheel::Cancel(int id)
+{
+	Unlink(id);
+}
+
+bool TimingWheel::IsScheduled(int id) const
+{
+	return nodes[id].slot != 0;
+}
+
+bool TimingWheel::IsIntact() const
+{
+	for (int s = 0; s < nLevels * nSlots; s++)
+	{
+		if (heads[s] < 0 || heads[s] > nEvents)
+		{
+			return false;
+		}
+	}
+	for (int id = 0; id < nEvents; id++)
+	{
+		const Node& node = nodes[id];
+		if (node.next < 0 || node.next > nEvents || node.prev < 0 || node.prev > nEvents
+			|| node.slot < 0 || node.slot > nLevels * nSlots)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+uint64_t TimingWheel::GetTime(int id) const
+{
+	return nodes[id].time;
+}
+
+uint64_t TimingWheel::GetNow() const
+{
+	return *pNow;
+}
+
+void TimingWheel::Advance(uint64_t time, PoolVector<int>& due)
+{
+	uint64_t& now = *pNow;
+	while (now <= time)
+	{
+		const int s = int(now & (nSlots - 1));
+		if (s == 0)
+		{
+			// the clock reached the next slot of the levels above, their events
+			// move down; a level only turns over when the one below wrapped
+			for (int level = 1; level < nLevels; level++)
+			{
+				const int slot = int((now >> (level * slotBits)) & (nSlots - 1));
+				TakeSlot(level * nSlots + slot, [this](int id) { Insert(id); });
+				if (slot != 0)
+				{
+					break;
+				}
+			}
+		}
+		// every event in a level 0 slot is due at now
+		const size_t first = due.size();
+		TakeSlot(s, [&due](int id) { due.push_back(id); });
+		// events scheduled in id order come out that way already
+		if (!std::is_sorted(due.begin() + first, due.end()))
+		{
+			std::sort(due.begin() + first, due.end());
+		}
+
+		const uint64_t next = NextStop();
+		if (next > time)
+		{
+			now = time + 1;
+			break;
+		}
+		now = next;
+	}
+}
+
+uint64_t TimingWheel::NextStop() const
+{
+	const uint64_t now = *pNow;
+	// the next busy slot of the finest level with one ahead in its current
+	// turn; earlier slots of that level and everything below are empty
+	for (int level = 0; level < nLevels - 1; level++)
+	{
+		const uint64_t slot = now >> (level * slotBits);
+		const int s = int(slot & (nSlots - 1));
+		const uint64_t ahead = s + 1 < nSlots ? occupied[level] >> (s + 1) : 0;
+		if (ahead != 0)
+		{
+			return (slot + 1 + BitBoard::LowestBit(ahead)) << (level * slotBits);
+		}
+	}
+	// the top level wraps around, it is walked slot by slot
+	return ((now >> ((nLevels - 1) * slotBits)) + 1) << ((nLevels - 1) * slotBits);
+}
+
+void TimingWheel::Insert(int id)
+{
+	Node& node = nodes[id];
+	const uint64_t now = *pNow;
+	// the coarsest level where time and now part, capped at the top level
+	int level = 0;
+	while (level + 1 < nLevels && (node.time >> ((level + 1) * slotBits)) != (now >> ((level + 1) * slotBits)))
+	{
+		level++;
+	}
+	uint64_t t = node.time;
+	const uint64_t span = uint64_t(1) << (nLevels * slotBits);
+	if (level == nLevels - 1 && t - now >= span)
+	{
+		// too far ahead: the last top slot before the clock comes round to it again
+		t = now + span - 1;
+	}
+	const int slot = level * nSlots + int((t >> (level * slotBits)) & (nSlots - 1));
+	node.slot = slot + 1;
+	node.next = 0;
+	const int head = heads[slot];
+	if (head == 0)
+	{
+		node.prev = id + 1;
+		heads[slot] = id + 1;
+	}
+	else
+	{
+		// appended, so a slot keeps the order events were scheduled in
+		Node& first = nodes[head - 1];
+		nodes[first.prev - 1].next = id + 1;
+		node.prev = first.prev;
+		first.prev = id + 1;
+	}
+	occupied[level] |= uint64_t(1) << (slot & (nSlots - 1));
+}
+
+void TimingWheel::Unlink(int id)
+{
+	Node& node = nodes[id];
+	if (node.slot == 0)
+	{
+		return;
+	}
+	const int slot = node.slot - 1;
+	const int head = heads[slot];
+	if (head == id + 1)
+	{
+		heads[slot] = node.next;
+	}
+	else
+	{
+		nodes[node.prev - 1].next = node.next;
+	}
+	if (node.next != 0)
+	{
+		nodes[node.next - 1].prev = node.prev;
+	}
+	else if (head != id + 1)
+	{
+		// the last one went, the first one points at the new last
+		nodes[head - 1].prev = node.prev;
+	}
+	if (heads[slot] == 0)
+	{
+		occupied[slot / nSlots] &= ~(uint64_t(1) << (slot & (nSlots - 1)));
+	}
+	node.slot = 0;
+}
+
+template<typename F>
+void TimingWheel::TakeSlot(int slot, F f)
+{
+	int i = heads[slot];
+	heads[slot] = 0;
+	occupied[slot / nSlots] &= ~(uint64_t(1) << (slot & (nSlots - 1)));
+	while (i != 0)
+	{
+		Node& node = nodes[i - 1];
+		const int next = node.next;
+		node.slot = 0;
+		f(i - 1);
+		i = next;
+	}
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include "GameState.h"
+#include "MemoryPool.h"
+#include <cstddef>
+#include <cstdint>
+
+// Events keyed by integer time, so the work per tick follows the events that
+// fire rather than the number of things that could. Event ids run 0..nEvents-1
+// and each is scheduled at most once at a time; scheduling it again moves it.
+// A hierarchical wheel: level l has 64 slots of 64^l time units each, an
+// event sits at the coarsest level where its time and the clock still differ
+// and drops a level each time the clock reaches its slot. Scheduling and
+// cancelling are O(1). Advance costs the events fired plus a step per busy
+// slot and per top level slot passed, empty stretches are skipped. All of it
+// lives in the GameState, so snapshots, rewind and checkpoints carry the
+// schedule along.
+class TimingWheel
+{
+public:
+	static constexpr int slotBits = 6;
+	static constexpr int nSlots = 1 << slotBits;
+	static constexpr int nLevels = 4;	// events up to 64^4 units ahead, later ones wait at the top
+
+public:
+	TimingWheel(GameState& state, int nEvents);
+	static size_t StateBytes(int nEvents);
+	// id fires once the clock reaches time; times already past fire on the next Advance
+	void Schedule(int id, uint64_t time);
+	void Cancel(int id);
+	bool IsScheduled(int id) const;
+	// the time id is scheduled for, or last fired at
+	uint64_t GetTime(int id) const;
+	// time units before which every event has fired
+	uint64_t GetNow() const;
+	// fires everything due up to and including time: the ids are appended to
+	// due, ordered by time and, at equal times, by id
+	void Advance(uint64_t time, PoolVector<int>& due);
+	// whether every link and slot refers to an id or slot that exists, for a
+	// state read from a file
+	bool IsIntact() const;
+
+private:
+	struct Node
+	{
+		uint64_t time;
+		int next;	// id + 1 in the same slot, 0 = none
+		int prev;	// the same, the first one's is the last one
+		int slot;	// level * nSlots + slot + 1, 0 = not scheduled
+	};
+	// the next time past now at which Advance has something to do
+	uint64_t NextStop() const;
+	void Insert(int id);
+	void Unlink(int id);
+	// empties a slot, handing its ids to f
+	template<typename F>
+	void TakeSlot(int slot, F f);
+
+private:
+	int nEvents;
+	Node* nodes;
+	int* heads;			// first id + 1 per slot of every level, in the order scheduled
+	uint64_t* occupied;	// per level, a bit per non-empty slot
+	uint64_t* pNow;
+};
@@ -0,0 +1,83 @@
+#include "Topology.h"
+
+constexpr int Topology::dx[4];
+constexpr int Topology::dy[4];
+
+Topology::Topology(const GameVariables& gVar, MemoryPool& memory)
+	:
+	Topology(gVar.topology == "walls" ? Kind::walls : Kind::torus, gVar.boardSizeX, gVar.boardSizeY, memory)
+{
+	for (size_t i = 0; i + 3 < gVar.portals.size(); i += 4)
+	{
+		AddPortal({ gVar.portals[i], gVar.portals[i + 1] }, { gVar.portals[i + 2], gVar.portals[i + 3] });
+	}
+}
+
+Topology::Topology(Kind kind, int width, int height, MemoryPool& memory)
+	:
+	kind(kind),
+	width(width),
+	height(height),
+	colTable(PoolAllocator<int>(memory)),
+	rowTable(PoolAllocator<int>(memory)),
+	portalCells(PoolAllocator<Location>(memory)),
+	portalOf(memory)
+{
+	BuildAxis(kind, width, colTable);
+	BuildAxis(kind, height, rowTable);
+}
+
+void Topology::AddPortal(const Location& a, const Location& b)
+{
+	const bool inside = a.x >= 0 && a.x < width && a.y >= 0 && a.y < height
+		&& b.x >= 0 && b.x < width && b.y >= 0 && b.y < height;
+	if (!inside || a == b || portalOf.Find(a) != CellMap::none || portalOf.Find(b) != CellMap::none)
+	{
+		return;
+	}
+	portalOf[a] = int(portalCells.size());
+	portalCells.push_back(a);
+	portalOf[b] = int(portalCells.size());
+	portalCells.push_back(b);
+}
+
+Topology::Kind Topology::GetKind() const
+{
+	return kind;
+}
+
+int Topology::GetWidth() const
+{
+	return width;
+}
+
+int Topology::GetHeight() const
+{
+	return height;
+}
+
+const PoolVector<Location>& Topology::GetPortalCells() const
+{
+	return portalCells;
+}
+
+void Topology::BuildAxis(Kind kind, int size, PoolVector<int>& table)
+{
+	table.resize(size_t(2 * maxStride + 1) * size);
+	for (int d = -maxStride; d <= maxStride; d++)
+	{
+		int* pRow = &table[size_t(d + maxStride) * size];
+		for (int i = 0; i < size; i++)
+		{
+			const int j = i + d;
+			if (kind == Kind::torus)
+			{
+				pRow[i] = ((j % size) + size) % size;
+			}
+			else
+			{
+				pRow[i] = (j >= 0 && j < size) ? j : -1;
+			}
+		}
+	}
+}
@@ -0,0 +1,99 @@
+#pragma once
+#include "Location.h"
+#include "CellMap.h"
+#include "MemoryPool.h"
+#include "GameVariables.h"
+#include <assert.h>
+#include <cstdlib>
+#include <vector>
+
+// How cells connect: across the board edges (torus wraps them, walls end the
+// board) and through portal pairs (landing on one end puts you on the other).
+// Moves are axis aligned, so where n steps lead is precomputed per column and
+// per row for every stride up to maxStride; a move is two table loads and a
+// portal probe, whatever the topology, with wrap overshoot handled exactly.
+// A wall entry means the straight path leaves the board, so a jump across the
+// edge of a walled board fails like a step onto it does. Jumps leap over the
+// cells in between, portals included.
+class Topology
+{
+public:
+	enum class Kind
+	{
+		torus,
+		walls
+	};
+	static constexpr int maxStride = 4;	// a jump moves Arena::jumpSize + 1 cells
+	// unit step of each dir
+	static constexpr int dx[4] = { 1,0,-1,0 };
+	static constexpr int dy[4] = { 0,1,0,-1 };
+
+public:
+	// tables come from memory
+	Topology(const GameVariables& gVar, MemoryPool& memory);
+	Topology(Kind kind, int width, int height, MemoryPool& memory);
+	// a portal between a and b, ignored if either is a portal already
+	void AddPortal(const Location& a, const Location& b);
+	// where stride steps along dir lead from loc; false if that leaves the board
+	bool Advance(const Location& loc, int dir, int stride, Location& out) const
+	{
+		assert(stride > 0 && stride <= maxStride);
+		const int nx = colTable[size_t(dx[dir] * stride + maxStride) * width + loc.x];
+		const int ny = rowTable[size_t(dy[dir] * stride + maxStride) * height + loc.y];
+		if ((nx | ny) < 0)
+		{
+			return false;
+		}
+		out = { nx, ny };
+		if (!portalCells.empty())
+		{
+			const int p = portalOf.Find(out);
+			if (p != CellMap::none)
+			{
+				out = portalCells[p ^ 1];
+			}
+		}
+		return true;
+	}
+	// the cell a successful Advance(from, dir, stride) started from, given where it led
+	Location Retreat(const Location& loc, int dir, int stride) const
+	{
+		Location from = loc;
+		if (!portalCells.empty())
+		{
+			// portal cells are only ever reached through their partner
+			const int p = portalOf.Find(loc);
+			if (p != CellMap::none)
+			{
+				from = portalCells[p ^ 1];
+			}
+		}
+		const int back = dir ^ 2;
+		return { colTable[size_t(dx[back] * stride + maxStride) * width + from.x],
+			rowTable[size_t(dy[back] * stride + maxStride) * height + from.y] };
+	}
+	Kind GetKind() const;
+	int GetWidth() const;
+	int GetHeight() const;
+	// both ends of every portal, the partner of entry i is entry i ^ 1
+	const PoolVector<Location>& GetPortalCells() const;
+	// 0 right, 1 down, 2 left, 3 up for a unit velocity
+	static int DirOf(const Location& v)
+	{
+		assert(abs(v.x) + abs(v.y) == 1);
+		return v.x == 1 ? 0 : v.y == 1 ? 1 : v.x == -1 ? 2 : 3;
+	}
+
+private:
+	static void BuildAxis(Kind kind, int size, PoolVector<int>& table);
+
+private:
+	Kind kind;
+	int width;
+	int height;
+	// [offset + maxStride][x or y] = destination column or row, -1 off a walled board
+	PoolVector<int> colTable;
+	PoolVector<int> rowTable;
+	PoolVector<Location> portalCells;
+	CellMap portalOf;	// index into portalCells
+};
@@ -0,0 +1,53 @@
+#include "MainWindow.h"
+#include "Game.h"
+#include "ChiliException.h"
+#include <iostream>
+
+// Linux entry point, mirrors wWinMain in Main.cpp
+int main( int argc,char** argv )
+{
+	std::wstring args;
+	for( int i = 1; i < argc; i++ )
+	{
+		const std::string arg( argv[i] );
+		args += (i > 1 ? L" " : L"") + std::wstring( arg.begin(),arg.end() );
+	}
+
+	try
+	{
+		MainWindow wnd( args );
+		try
+		{
+			Game theGame( wnd );
+			while( wnd.ProcessMessage() )
+			{
+				theGame.Go();
+			}
+		}
+		catch( const ChiliException& e )
+		{
+			const std::wstring eMsg = e.GetFullMessage() +
+				L"\n\nException caught at X11 event loop.";
+			wnd.ShowMessageBox( e.GetExceptionType(),eMsg );
+		}
+		catch( const std::exception& e )
+		{
+			std::cerr << "Unhandled STL Exception\n" << e.what()
+				<< "\n\nException caught at X11 event loop." << std::endl;
+		}
+	}
+	catch( const ChiliException& e )
+	{
+		const std::wstring eMsg = e.GetFullMessage() + L"\n\nException caught at main window creation.";
+		std::cerr << std::string( eMsg.begin(),eMsg.end() ) << std::endl;
+		return 1;
+	}
+	catch( const std::exception& e )
+	{
+		std::cerr << "Unhandled STL Exception\n" << e.what()
+			<< "\n\nException caught at main window creation." << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
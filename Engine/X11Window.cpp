@@ -0,0 +1,198 @@
+#include "MainWindow.h"
+#include <X11/Xlib.h>
+#include <X11/Xutil.h>
+#include <X11/XKBlib.h>
+#include <X11/keysym.h>
+#include <iostream>
+
+namespace
+{
+	// maps X keysyms onto the Windows virtual-key codes used by Game
+	unsigned char TranslateKeySym( KeySym ks )
+	{
+		if( ks >= XK_a && ks <= XK_z )
+		{
+			return static_cast<unsigned char>( 'A' + (ks - XK_a) );
+		}
+		if( (ks >= XK_A && ks <= XK_Z) || (ks >= XK_0 && ks <= XK_9) )
+		{
+			return static_cast<unsigned char>( ks );
+		}
+		if( ks >= XK_KP_0 && ks <= XK_KP_9 )
+		{
+			return static_cast<unsigned char>( 0x60 + (ks - XK_KP_0) );
+		}
+		switch( ks )
+		{
+		// keypad with num lock off still drives the numpad controls
+		case XK_KP_Insert: return 0x60;
+		case XK_KP_End: return 0x61;
+		case XK_KP_Down: return 0x62;
+		case XK_KP_Next: return 0x63;
+		case XK_KP_Left: return 0x64;
+		case XK_KP_Begin: return 0x65;
+		case XK_KP_Right: return 0x66;
+		case XK_KP_Home: return 0x67;
+		case XK_KP_Up: return 0x68;
+		case XK_KP_Prior: return 0x69;
+		case XK_BackSpace: return VK_BACK;
+		case XK_Return:
+		case XK_KP_Enter: return VK_RETURN;
+		case XK_Escape: return VK_ESCAPE;
+		case XK_space: return VK_SPACE;
+		case XK_Left: return VK_LEFT;
+		case XK_Up: return VK_UP;
+		case XK_Right: return VK_RIGHT;
+		case XK_Down: return VK_DOWN;
+		}
+		return 0u;
+	}
+}
+
+MainWindow::MainWindow( const std::wstring& args )
+	:
+	args( args )
+{
+	pDisplay = XOpenDisplay( nullptr );
+	if( pDisplay == nullptr )
+	{
+		throw Exception( _CRT_WIDE( __FILE__ ),__LINE__,
+			L"Failed to open X display (is DISPLAY set?)." );
+	}
+	const int screen = DefaultScreen( pDisplay );
+	window = XCreateSimpleWindow( pDisplay,RootWindow( pDisplay,screen ),
+		350,100,Graphics::ScreenWidth,Graphics::ScreenHeight,0,
+		BlackPixel( pDisplay,screen ),BlackPixel( pDisplay,screen ) );
+	XStoreName( pDisplay,window,"Chili DirectX Framework" );
+
+	// fixed size, like the Win32 window
+	XSizeHints* pHints = XAllocSizeHints();
+	pHints->flags = PMinSize | PMaxSize;
+	pHints->min_width = pHints->max_width = Graphics::ScreenWidth;
+	pHints->min_height = pHints->max_height = Graphics::ScreenHeight;
+	XSetWMNormalHints( pDisplay,window,pHints );
+	XFree( pHints );
+
+	XSelectInput( pDisplay,window,KeyPressMask | KeyReleaseMask | ButtonPressMask |
+		ButtonReleaseMask | PointerMotionMask | EnterWindowMask | LeaveWindowMask |
+		FocusChangeMask | StructureNotifyMask );
+	Atom deleteAtom = XInternAtom( pDisplay,"WM_DELETE_WINDOW",False );
+	XSetWMProtocols( pDisplay,window,&deleteAtom,1 );
+	wmDeleteWindow = deleteAtom;
+	// deliver held keys as repeated presses without the fake releases in between
+	XkbSetDetectableAutoRepeat( pDisplay,True,nullptr );
+
+	XMapWindow( pDisplay,window );
+	XFlush( pDisplay );
+}
+
+MainWindow::~MainWindow()
+{
+	XDestroyWindow( pDisplay,window );
+	XCloseDisplay( pDisplay );
+}
+
+bool MainWindow::IsActive() const
+{
+	return isActive;
+}
+
+bool MainWindow::IsMinimized() const
+{
+	return isMinimized;
+}
+
+void MainWindow::ShowMessageBox( const std::wstring& title,const std::wstring& message ) const
+{
+	std::cerr << std::string( title.begin(),title.end() ) << "\n"
+		<< std::string( message.begin(),message.end() ) << std::endl;
+}
+
+bool MainWindow::ProcessMessage()
+{
+	while( !quitRequested && XPending( pDisplay ) > 0 )
+	{
+		XEvent e;
+		XNextEvent( pDisplay,&e );
+		switch( e.type )
+		{
+		case ClientMessage:
+			if( static_cast<unsigned long>( e.xclient.data.l[0] ) == wmDeleteWindow )
+			{
+				quitRequested = true;
+			}
+			break;
+		case FocusIn:
+			isActive = true;
+			break;
+		case FocusOut:
+			isActive = false;
+			break;
+		case MapNotify:
+			isMinimized = false;
+			break;
+		case UnmapNotify:
+			isMinimized = true;
+			break;
+
+			// ************ KEYBOARD MESSAGES ************ //
+		case KeyPress:
+			HandleKey( e,true );
+			break;
+		case KeyRelease:
+			HandleKey( e,false );
+			break;
+			// ************ END KEYBOARD MESSAGES ************ //
+
+			// ************ MOUSE MESSAGES ************ //
+		case MotionNotify:
+			mouse.OnMouseMove( e.xmotion.x,e.xmotion.y );
+			break;
+		case EnterNotify:
+			mouse.OnMouseEnter();
+			break;
+		case LeaveNotify:
+			mouse.OnMouseLeave();
+			break;
+		case ButtonPress:
+			switch( e.xbutton.button )
+			{
+			case Button1: mouse.OnLeftPressed( e.xbutton.x,e.xbutton.y ); break;
+			case Button3: mouse.OnRightPressed( e.xbutton.x,e.xbutton.y ); break;
+			case Button4: mouse.OnWheelUp( e.xbutton.x,e.xbutton.y ); break;
+			case Button5: mouse.OnWheelDown( e.xbutton.x,e.xbutton.y ); break;
+			}
+			break;
+		case ButtonRelease:
+			switch( e.xbutton.button )
+			{
+			case Button1: mouse.OnLeftReleased( e.xbutton.x,e.xbutton.y ); break;
+			case Button3: mouse.OnRightReleased( e.xbutton.x,e.xbutton.y ); break;
+			}
+			break;
+			// ************ END MOUSE MESSAGES ************ //
+		}
+	}
+	return !quitRequested;
+}
+
+void MainWindow::HandleKey( XEvent& e,bool pressed )
+{
+	const unsigned char code = TranslateKeySym( XLookupKeysym( &e.xkey,0 ) );
+	if( pressed )
+	{
+		if( code != 0u && (!kbd.KeyIsPressed( code ) || kbd.AutorepeatIsEnabled()) ) // no thank you on the autorepeat
+		{
+			kbd.OnKeyPressed( code );
+		}
+		char text[8];
+		if( XLookupString( &e.xkey,text,sizeof( text ),nullptr,nullptr ) == 1 )
+		{
+			kbd.OnChar( text[0] );
+		}
+	}
+	else if( code != 0u )
+	{
+		kbd.OnKeyReleased( code );
+	}
+}
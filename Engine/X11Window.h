@@ -0,0 +1,80 @@
+#pragma once
+#include "Graphics.h"
+#include "Keyboard.h"
+#include "Mouse.h"
+#include "ChiliException.h"
+#include <string>
+
+// Linux counterpart of the Win32 MainWindow (included through MainWindow.h).
+// Key events are translated to the Windows virtual-key codes that Game polls,
+// so game code is identical on both platforms.
+#ifndef _CRT_WIDE
+#define __CRT_WIDE( s ) L ## s
+#define _CRT_WIDE( s ) __CRT_WIDE( s )
+#endif
+
+#ifndef VK_RETURN
+#define VK_BACK		0x08
+#define VK_RETURN	0x0D
+#define VK_ESCAPE	0x1B
+#define VK_SPACE	0x20
+#define VK_LEFT		0x25
+#define VK_UP		0x26
+#define VK_RIGHT	0x27
+#define VK_DOWN		0x28
+#endif
+
+// for granting special access to the X11 display/window only for Graphics constructor
+class HWNDKey
+{
+	friend Graphics::Graphics( HWNDKey& );
+public:
+	HWNDKey( const HWNDKey& ) = delete;
+	HWNDKey& operator=( HWNDKey& ) = delete;
+protected:
+	HWNDKey() = default;
+protected:
+	struct _XDisplay* pDisplay = nullptr;
+	unsigned long window = 0;
+};
+
+class MainWindow : public HWNDKey
+{
+public:
+	class Exception : public ChiliException
+	{
+	public:
+		using ChiliException::ChiliException;
+		virtual std::wstring GetFullMessage() const override { return GetNote() + L"\nAt: " + GetLocation(); }
+		virtual std::wstring GetExceptionType() const override { return L"X11 Exception"; }
+	};
+public:
+	MainWindow( const std::wstring& args );
+	MainWindow( const MainWindow& ) = delete;
+	MainWindow& operator=( const MainWindow& ) = delete;
+	~MainWindow();
+	bool IsActive() const;
+	bool IsMinimized() const;
+	void ShowMessageBox( const std::wstring& title,const std::wstring& message ) const;
+	void Kill()
+	{
+		quitRequested = true;
+	}
+	// returns false if quitting
+	bool ProcessMessage();
+	const std::wstring& GetArgs() const
+	{
+		return args;
+	}
+private:
+	void HandleKey( union _XEvent& e,bool pressed );
+public:
+	Keyboard kbd;
+	Mouse mouse;
+private:
+	unsigned long wmDeleteWindow = 0;
+	bool isActive = false;
+	bool isMinimized = false;
+	bool quitRequested = false;
+	std::wstring args;
+};
@@ -0,0 +1,35 @@
+#pragma once
+#include "Location.h"
+#include <cstdint>
+
+// Keys for the 64-bit Zobrist hashes of a position. Boards can be far too big
+// for a table of random keys per cell, so a key is a strong mix of what it
+// stands for instead. A hash is the XOR of the keys of everything present and
+// follows a change with one XOR out and one XOR in.
+struct Zobrist
+{
+	// SplitMix64 finaliser
+	static uint64_t Mix(uint64_t x)
+	{
+		x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9;
+		x = (x ^ (x >> 27)) * 0x94d049bb133111eb;
+		return x ^ (x >> 31);
+	}
+	// content (0 = empty, which adds nothing) at (x, y)
+	static uint64_t CellKey(int x, int y, int content)
+	{
+		if (content == 0)
+		{
+			return 0;
+		}
+		const uint64_t cell = (uint64_t(unsigned(y)) << 32) | unsigned(x);
+		return Mix(cell + uint64_t(content) * 0x9e3779b97f4a7c15);
+	}
+	// snake id with its head at head, moving at velocity (each component -1..1)
+	static uint64_t SnakeKey(int id, const Location& head, const Location& velocity)
+	{
+		const uint64_t cell = (uint64_t(unsigned(head.y)) << 32) | unsigned(head.x);
+		const uint64_t what = uint64_t(id) * 16 + uint64_t((velocity.x + 1) * 3 + velocity.y + 1);
+		return Mix(cell ^ Mix(what + 0x9e3779b97f4a7c15));
+	}
+};
@@ -0,0 +1,169 @@
+#include "AllocationCounter.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+namespace
+{
+	std::atomic<bool> armed{ false };
+	std::atomic<long long> count{ 0 };
+
+	void* Allocate(std::size_t size) noexcept
+	{
+		if (armed.load(std::memory_order_relaxed))
+		{
+			count.fetch_add(1, std::memory_order_relaxed);
+		}
+		return std::malloc(size != 0 ? size : 1);
+	}
+
+	void* AllocateAligned(std::size_t size, std::align_val_t alignment) noexcept
+	{
+		if (armed.load(std::memory_order_relaxed))
+		{
+			count.fetch_add(1, std::memory_order_relaxed);
+		}
+		const std::size_t a = std::size_t(alignment);
+#ifdef _WIN32
+		return _aligned_malloc(std::max(size, std::size_t(1)), a);
+#else
+		// aligned_alloc takes whole multiples of the alignment only
+		return std::aligned_alloc(a, (std::max(size, std::size_t(1)) + a - 1) / a * a);
+#endif
+	}
+
+	void FreeAligned(void* p) noexcept
+	{
+#ifdef _WIN32
+		_aligned_free(p);
+#else
+		std::free(p);
+#endif
+	}
+
+	void* OrThrow(void* p)
+	{
+		if (p == nullptr)
+		{
+			throw std::bad_alloc();
+		}
+		return p;
+	}
+}
+
+void AllocationCounter::Arm()
+{
+	count = 0;
+	armed = true;
+}
+
+long long AllocationCounter::Disarm()
+{
+	armed = false;
+	return count;
+}
+
+// every replaceable form, so no allocation goes around the count
+void* operator new(std::size_t size)
+{
+	return OrThrow(Allocate(size));
+}
+
+void* operator new[](std::size_t size)
+{
+	return OrThrow(Allocate(size));
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+	return Allocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+	return Allocate(size);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+	return OrThrow(AllocateAligned(size, alignment));
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment)
+{
+	return OrThrow(AllocateAligned(size, alignment));
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+	return AllocateAligned(size, alignment);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+	return AllocateAligned(size, alignment);
+}
+
+void operator delete(void* p) noexcept
+{
+	std::free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+	std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+	std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept
+{
+	std::free(p);
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept
+{
+	std::free(p);
+}
+
+void operator delete[](void* p, const std::nothrow_t&) noexcept
+{
+	std::free(p);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept
+{
+	FreeAligned(p);
+}
+
+void operator delete[](void* p, std::align_val_t) noexcept
+{
+	FreeAligned(p);
+}
+
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept
+{
+	FreeAligned(p);
+}
+
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept
+{
+	FreeAligned(p);
+}
+
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept
+{
+	FreeAligned(p);
+}
+
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept
+{
+	FreeAligned(p);
+}
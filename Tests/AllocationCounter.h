@@ -0,0 +1,14 @@
+#pragma once
+
+// Counts heap allocations made through any form of the global operator new
+// (plain, array, aligned, nothrow), on any thread, while armed; MemoryPool
+// takes its chunks through it too. Linked into SteadyStateAllocTest only, so
+// the game keeps the standard allocator; the test arms it after its warm-up
+// and fails on anything that starts allocating in the steady state.
+class AllocationCounter
+{
+public:
+	static void Arm();
+	// allocations since Arm
+	static long long Disarm();
+};
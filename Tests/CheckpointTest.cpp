@@ -0,0 +1,74 @@
+#include "Headless.h"
+#include "Checkpoint.h"
+#include "MappedFile.h"
+#include <cstdio>
+
+// Saves a game, resumes it into a second one, which has to match, and from
+// there saves again over the checkpoint the second game still has mapped; a
+// third game resumed from that has to match the second. A checkpoint saved
+// under other rules and one with garbage in its block are both refused, and
+// leave the game that tried them as it was.
+// CheckpointTest [ticks]
+int main(int argc, char* argv[])
+{
+	GameVariables gVar("data.txt");
+	const int nTicks = int(Arg(argc, argv, 1, 300));
+	gVar.boardSizeX = 200;
+	gVar.boardSizeY = 150;
+	gVar.numPlayers = 0;
+	gVar.numSnakes = 50;
+	gVar.foodAmount = 60;
+	const float dt = 1.0f / 60.0f;
+	const std::string filename = "CheckpointTest.ckpt";
+	Check check;
+
+	Headless first(gVar, 31);
+	for (int t = 0; t < nTicks; t++)
+	{
+		first.Step(dt);
+	}
+	{
+		Checkpoint checkpoint(filename, gVar);
+		check(checkpoint.Save(first.state), "save");
+	}
+	Headless second(gVar, 32);
+	check(Checkpoint::Load(filename, gVar, second.state, [&] { return second.IsIntact(); })
+		&& second.IsSameState(first), "resume");
+	for (int t = 0; t < nTicks; t++)
+	{
+		first.Step(dt);
+		second.Step(dt);
+	}
+	check(second.IsSameState(first), "the resumed game runs on as the first");
+	{
+		Checkpoint checkpoint(filename, gVar);
+		check(checkpoint.Save(second.state), "save over the checkpoint in use");
+	}
+	Headless third(gVar, 33);
+	check(Checkpoint::Load(filename, gVar, third.state, [&] { return third.IsIntact(); })
+		&& third.IsSameState(second), "resume that");
+
+	// same sizes, so the same capacity, but other rules
+	GameVariables otherRules = gVar;
+	otherRules.barrierOnEat = 1 - gVar.barrierOnEat;
+	Headless fourth(otherRules, 34);
+	Headless fourthAsBuilt(otherRules, 34);
+	check(!Checkpoint::Load(filename, otherRules, fourth.state, [&] { return fourth.IsIntact(); })
+		&& fourth.IsSameState(fourthAsBuilt), "a checkpoint of another config is refused");
+
+	// everything past the block's own header overwritten
+	{
+		const size_t dataOffset = size_t(1) << 16;
+		MappedFile file(filename, MappedFile::Mode::ReadWrite, dataOffset, third.state.GetUsed());
+		if (check(file.IsOpen(), "open the checkpoint"))
+		{
+			memset(static_cast<char*>(file.GetData()) + 16, 0xA5, third.state.GetUsed() - 16);
+		}
+	}
+	Headless fifth(gVar, 35);
+	Headless fifthAsBuilt(gVar, 35);
+	check(!Checkpoint::Load(filename, gVar, fifth.state, [&] { return fifth.IsIntact(); })
+		&& fifth.IsSameState(fifthAsBuilt), "a damaged checkpoint is refused");
+	std::remove(filename.c_str());
+	return check.GetExitCode();
+}
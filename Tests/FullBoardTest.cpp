@@ -0,0 +1,49 @@
+#include "Headless.h"
+#include <cstdio>
+
+// Fills a board up to its last free cells and checks spawning finds exactly
+// those, then reports a full board instead of searching it forever.
+int main()
+{
+	GameVariables gVar("data.txt");
+	gVar.boardSizeX = 40;
+	gVar.boardSizeY = 30;
+	gVar.topology = "walls";
+	gVar.numPlayers = 0;
+	gVar.numSnakes = 1;
+	gVar.foodAmount = 1;
+	gVar.poisonAmount = 0;
+	Headless game(gVar, 5);
+	Board& brd = game.brd;
+	Check check;
+
+	// everything barrier but the snake and two cells
+	const Location spare[2] = { { 3, 7 }, { 38, 29 } };
+	for (int y = 0; y < gVar.boardSizeY; y++)
+	{
+		for (int x = 0; x < gVar.boardSizeX; x++)
+		{
+			if (brd.GetCellContent({ x, y }) != Board::contentType::snake)
+			{
+				brd.SetCellContent({ x, y }, Board::contentType::barrier);
+			}
+		}
+	}
+	for (const Location& loc : spare)
+	{
+		brd.SetCellContent(loc, Board::contentType::empty);
+	}
+	Location where[2];
+	check(brd.Spawn(Board::contentType::food, game.rng, where[0])
+		&& brd.Spawn(Board::contentType::food, game.rng, where[1])
+		&& where[0] != where[1]
+		&& (where[0] == spare[0] || where[0] == spare[1]) && (where[1] == spare[0] || where[1] == spare[1]),
+		"the last free cells are found");
+	check(!brd.Spawn(Board::contentType::food, game.rng, where[0]), "a full board spawns nothing");
+
+	const int length = game.arena.GetLength(0);
+	check(game.arena.SpawnAnywhere(0, brd, game.rng) && game.arena.GetLength(0) > 0 && !game.arena.IsCrashed(0),
+		"a snake respawns where it was");
+	check(brd.CountContent(Board::contentType::empty) == length - game.arena.GetLength(0), "and only there");
+	return check.GetExitCode();
+}
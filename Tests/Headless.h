@@ -0,0 +1,129 @@
+#pragma once
+#include "Arena.h"
+#include "Board.h"
+#include "GameState.h"
+#include "GameVariables.h"
+#include "Graphics.h"
+#include "MemoryPool.h"
+#include "Rng.h"
+#include "TickWrites.h"
+#include "Topology.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+
+// A game without a window, for the tests and benchmarks: the state, pool,
+// topology, arena and board Game owns, laid out the same way. Every snake is
+// a wandering drone and crashed ones respawn, so ticks keep going on their
+// own. Board draws into a headless Graphics, never presented.
+class Headless
+{
+public:
+	Headless(const GameVariables& gVar_in, uint64_t seed)
+		:
+		gVar(gVar_in),
+		nSnakes(std::max(gVar.numSnakes, 1)),
+		state(StateBytes(gVar, nSnakes)),
+		rng(state.Construct<Rng>(seed, 0)),
+		topology(gVar, memory),
+		arena(gVar, topology, nSnakes, state, memory),
+		brd(gfx, gVar, state, memory)
+	{
+		arena.SetWanderers(0);
+		for (int id = 0; id < nSnakes; id++)
+		{
+			arena.SpawnAnywhere(id, brd, rng);
+		}
+		arena.SpawnItems(Board::contentType::food, std::max(1, gVar.foodAmount), brd, rng);
+		arena.SpawnItems(Board::contentType::poison, gVar.poisonAmount, brd, rng);
+	}
+	static size_t StateBytes(const GameVariables& gVar, int nSnakes)
+	{
+		return GameState::Bound<Rng>(1) + Arena::StateBytes(gVar, nSnakes) + Board::StateBytes(gVar);
+	}
+	// one tick as Game runs it, the snakes that crashed back elsewhere; how many
+	int Step(float dt)
+	{
+		brd.GetJournal().Clear();
+		arena.Tick(dt, brd, rng);
+		int nCrashed = 0;
+		for (int id = 0; id < nSnakes; id++)
+		{
+			if (arena.IsCrashed(id))
+			{
+				arena.SpawnAnywhere(id, brd, rng);
+				nCrashed++;
+			}
+		}
+		return nCrashed;
+	}
+	// what Game hands its RewindBuffer: the state written since the last record
+	void AddTickWrites(size_t recordedBytes, TickWrites& writes)
+	{
+		writes.Add(state.OffsetOf(&rng), sizeof(Rng));
+		arena.AddTickWrites(brd.GetJournal(), writes);
+		brd.AddTickWrites(recordedBytes, writes);
+	}
+	// what Game checks a resumed state with
+	bool IsIntact() const
+	{
+		return arena.IsIntact() && brd.IsIntact();
+	}
+	uint64_t GetHash() const
+	{
+		return brd.GetHash() ^ arena.GetHash();
+	}
+	// byte for byte, which only means something for games of the same config
+	bool IsSameState(const Headless& other) const
+	{
+		return state.GetUsed() == other.state.GetUsed()
+			&& memcmp(state.GetData(), other.state.GetData(), state.GetUsed()) == 0;
+	}
+
+public:
+	GameVariables gVar;
+	const int nSnakes;
+	GameState state;
+	MemoryPool memory;
+	Rng& rng;
+	Topology topology;
+	Arena arena;
+	Graphics gfx;
+	Board brd;
+};
+
+// Prints each check and whether it held; main returns GetExitCode().
+class Check
+{
+public:
+	bool operator()(bool passed, const std::string& what)
+	{
+		printf("%s: %s\n", what.c_str(), passed ? "ok" : "FAILED");
+		ok = ok && passed;
+		return passed;
+	}
+	int GetExitCode() const
+	{
+		return ok ? 0 : 1;
+	}
+
+private:
+	bool ok = true;
+};
+
+// argument i as a number, or fallback
+inline long long Arg(int argc, char* argv[], int i, long long fallback)
+{
+	return i < argc ? std::atoll(argv[i]) : fallback;
+}
+
+inline double MillisecondsSince(std::chrono::steady_clock::time_point t0)
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+}
@@ -0,0 +1,111 @@
+#include "Headless.h"
+#include "Level.h"
+#include "MazeGenerator.h"
+#include <cstdio>
+#include <fstream>
+
+// Saves a maze with zones as a level file and loads it back, checking cells,
+// zones and hash survive and that the file is no longer than its barrier
+// rows; writes a tiny level and compares it byte for byte with the format;
+// then damages copies of the file (cut short, another version) and checks
+// Load turns them down.
+// LevelFileTest [width] [height]
+namespace
+{
+	const char* const filename = "LevelFileTest.lvl";
+	const char* const damagedName = "LevelFileTest.damaged.lvl";
+	// magic, version, width, height and zone count
+	constexpr size_t headerBytes = 8 + 4 * 4;
+	constexpr size_t zoneBytes = 4 * 4;
+
+	bool IsSame(const Level& a, const Level& b)
+	{
+		if (a.GetWidth() != b.GetWidth() || a.GetHeight() != b.GetHeight()
+			|| a.GetCells().GetHash() != b.GetCells().GetHash() || a.GetZones().size() != b.GetZones().size())
+		{
+			return false;
+		}
+		for (size_t i = 0; i < a.GetZones().size(); i++)
+		{
+			const Level::Zone& za = a.GetZones()[i];
+			const Level::Zone& zb = b.GetZones()[i];
+			if (za.x0 != zb.x0 || za.y0 != zb.y0 || za.x1 != zb.x1 || za.y1 != zb.y1)
+			{
+				return false;
+			}
+		}
+		for (int y = 0; y < a.GetHeight(); y++)
+		{
+			for (int x = 0; x < a.GetWidth(); x++)
+			{
+				if (a.GetCells().Get(x, y) != b.GetCells().Get(x, y))
+				{
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+
+	std::string ReadAll(const char* name)
+	{
+		std::ifstream in(name, std::ios::binary);
+		return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+	}
+
+	void WriteAll(const char* name, const std::string& bytes)
+	{
+		std::ofstream(name, std::ios::binary | std::ios::trunc).write(bytes.data(), std::streamsize(bytes.size()));
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	MazeGenerator::Params params;
+	params.width = int(Arg(argc, argv, 1, 300));
+	params.height = int(Arg(argc, argv, 2, 200));
+	const auto level = MazeGenerator::GenerateOne(params, 99);
+	level->AddZone({ 0, 0, params.width / 4, params.height / 4 });
+	level->AddZone({ params.width / 2, params.height / 2, params.width, params.height });
+	Check check;
+
+	check(level->Save(filename), "save");
+	const auto loaded = Level::Load(filename);
+	check(loaded && IsSame(*level, *loaded), "load gives the saved level");
+	check(loaded && loaded->GetCells().ComputeHash() == level->GetCells().GetHash(), "loaded cells hash as saved");
+
+	const std::string bytes = ReadAll(filename);
+	const size_t rowBytes = size_t(params.width + 63) / 64 * sizeof(uint64_t);
+	check(bytes.size() == headerBytes + 2 * zoneBytes + size_t(params.height) * rowBytes,
+		"the file is the header, the zones and one bit per cell");
+
+	// 70 x 2, barriers at (1, 0), (65, 0) and (69, 1), one zone
+	{
+		Level tiny(70, 2);
+		tiny.Set(1, 0, Board::contentType::barrier);
+		tiny.Set(65, 0, Board::contentType::barrier);
+		tiny.Set(69, 1, Board::contentType::barrier);
+		tiny.AddZone({ 2, 0, 5, 1 });
+		const unsigned char expected[] = {
+			'S','N','E','K','L','E','V','L',
+			2,0,0,0, 70,0,0,0, 2,0,0,0, 1,0,0,0,
+			2,0,0,0, 0,0,0,0, 5,0,0,0, 1,0,0,0,
+			2,0,0,0,0,0,0,0, 2,0,0,0,0,0,0,0,
+			0,0,0,0,0,0,0,0, 32,0,0,0,0,0,0,0 };
+		check(tiny.Save(damagedName)
+			&& ReadAll(damagedName) == std::string(reinterpret_cast<const char*>(expected), sizeof(expected)),
+			"a tiny level is written little-endian, row by row");
+	}
+
+	WriteAll(damagedName, bytes.substr(0, bytes.size() - 1));
+	check(!Level::Load(damagedName), "a file cut short is turned down");
+
+	std::string damaged = bytes;
+	damaged[8] = 1;
+	WriteAll(damagedName, damaged);
+	check(!Level::Load(damagedName), "another version is turned down");
+
+	std::remove(filename);
+	std::remove(damagedName);
+	return check.GetExitCode();
+}
@@ -0,0 +1,114 @@
+#include "Headless.h"
+#include "MazeGenerator.h"
+#include <cstdio>
+#include <vector>
+
+// Generates arenas of both styles at several thread counts, checks that a
+// seed gives the same arenas for any thread count, that arena 0 is the one
+// GenerateOne gives, and that every open cell is reachable; prints arenas/s.
+// MazeGeneratorTest [arenas] [board size]
+namespace
+{
+	bool IsSame(const Level& a, const Level& b)
+	{
+		for (int y = 0; y < a.GetHeight(); y++)
+		{
+			for (int x = 0; x < a.GetWidth(); x++)
+			{
+				if (a.GetCells().Get(x, y) != b.GetCells().Get(x, y))
+				{
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+
+	// open cells reached from the first one through edge neighbours, against all open cells
+	bool IsConnected(const Level& level)
+	{
+		const int width = level.GetWidth();
+		const int height = level.GetHeight();
+		const BitBoard& cells = level.GetCells();
+		std::vector<unsigned char> seen(size_t(width) * height, 0);
+		std::vector<int> stack;
+		int nOpen = 0;
+		for (int i = 0; i < width * height; i++)
+		{
+			if (cells.Get(i % width, i / width) != Board::contentType::barrier)
+			{
+				if (nOpen++ == 0)
+				{
+					seen[i] = 1;
+					stack.push_back(i);
+				}
+			}
+		}
+		int nReached = 0;
+		while (!stack.empty())
+		{
+			const int i = stack.back();
+			stack.pop_back();
+			nReached++;
+			const int x = i % width;
+			const int y = i / width;
+			const int next[4][2] = { { x + 1, y }, { x - 1, y }, { x, y + 1 }, { x, y - 1 } };
+			for (const auto& n : next)
+			{
+				if (n[0] >= 0 && n[0] < width && n[1] >= 0 && n[1] < height)
+				{
+					const int j = n[1] * width + n[0];
+					if (!seen[j] && cells.Get(n[0], n[1]) != Board::contentType::barrier)
+					{
+						seen[j] = 1;
+						stack.push_back(j);
+					}
+				}
+			}
+		}
+		return nOpen > 0 && nReached == nOpen;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	const int nArenas = int(Arg(argc, argv, 1, 32));
+	const int size = int(Arg(argc, argv, 2, 128));
+	const uint64_t seed = 2024;
+	bool ok = true;
+	for (const char* styleName : { "division", "caves" })
+	{
+		MazeGenerator::Params params;
+		params.width = params.height = size;
+		MazeGenerator::ParseStyle(styleName, params.style);
+		std::vector<std::shared_ptr<Level>> serial;
+		for (int nThreads : { 1, 2, 4, 8 })
+		{
+			MazeGenerator generator(nThreads);
+			const auto t0 = std::chrono::steady_clock::now();
+			const auto levels = generator.Generate(params, seed, nArenas);
+			const double ms = MillisecondsSince(t0);
+			int nDiffer = 0;
+			int nSplit = 0;
+			for (int i = 0; i < nArenas; i++)
+			{
+				nDiffer += !serial.empty() && !IsSame(*levels[i], *serial[i]);
+				nSplit += !IsConnected(*levels[i]);
+			}
+			printf("%s, %d threads: %.1f arenas/s, %d differ from 1 thread, %d not connected\n",
+				styleName, nThreads, nArenas * 1000.0 / ms, nDiffer, nSplit);
+			ok = ok && nDiffer == 0 && nSplit == 0;
+			if (serial.empty())
+			{
+				serial = levels;
+			}
+		}
+		if (!IsSame(*MazeGenerator::GenerateOne(params, seed), *serial[0]))
+		{
+			printf("%s: GenerateOne differs from arena 0\n", styleName);
+			ok = false;
+		}
+	}
+	printf("%d arenas of %dx%d, %u hardware threads\n", nArenas, size, size, std::thread::hardware_concurrency());
+	return ok ? 0 : 1;
+}
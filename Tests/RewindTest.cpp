@@ -0,0 +1,88 @@
+#include "Headless.h"
+#include "RewindBuffer.h"
+#include <cstdio>
+#include <vector>
+
+// Records a game tick by tick, then checks that rebuilding and stepping back
+// N ticks give the state the game had N ticks ago, byte for byte, also after
+// carrying on from a step back; prints what a record costs against the size
+// of the state, which it should not follow.
+// RewindTest [ticks] [board size]
+namespace
+{
+	// a rebuilt block may run on in zeros where the state has since grown
+	bool IsSame(const std::vector<uint64_t>& rebuilt, const std::vector<uint64_t>& expected)
+	{
+		return rebuilt.size() >= expected.size() && std::equal(expected.begin(), expected.end(), rebuilt.begin())
+			&& std::all_of(rebuilt.begin() + expected.size(), rebuilt.end(), [](uint64_t w) { return w == 0; });
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	GameVariables gVar("data.txt");
+	const int nTicks = int(Arg(argc, argv, 1, 600));
+	gVar.boardSizeX = gVar.boardSizeY = int(Arg(argc, argv, 2, 1024));
+	gVar.numPlayers = 0;
+	gVar.numSnakes = 100;
+	gVar.foodAmount = 200;
+	gVar.foodLifetime = 2.0f;
+	// turns on the journal and the freed block log records are built from
+	gVar.rewindBudget = 256;
+	const float dt = 1.0f / 60.0f;
+	Check check;
+
+	Headless game(gVar, 23);
+	// barriers over a good part of the board, so the block is large
+	for (int k = 0; k < gVar.boardSizeX * gVar.boardSizeY / 16; k++)
+	{
+		Location loc;
+		game.brd.Spawn(Board::contentType::barrier, game.rng, loc);
+	}
+	RewindBuffer rewind(size_t(gVar.rewindBudget) << 20, 100, game.state.GetCapacity());
+	TickWrites writes(game.memory, 1024);
+	const auto record = [&]
+	{
+		writes.Clear();
+		game.AddTickWrites(rewind.GetRecordedBytes(), writes);
+		rewind.Record(game.state, writes);
+	};
+	std::vector<std::vector<uint64_t>> history(nTicks + 1);
+	record();
+	game.state.Snapshot(history[0]);
+	double recordMs = 0.0;
+	for (int t = 1; t <= nTicks; t++)
+	{
+		game.Step(dt);
+		const auto t0 = std::chrono::steady_clock::now();
+		record();
+		recordMs += MillisecondsSince(t0);
+		game.state.Snapshot(history[t]);
+	}
+	printf("record: %.1f us per tick for a %zu byte state\n", 1000.0 * recordMs / nTicks, game.state.GetUsed());
+
+	for (int back : { 0, 1, 37, 99, 100, 250, nTicks })
+	{
+		std::vector<uint64_t> rebuilt;
+		check(rewind.Reconstruct(back, rebuilt) && IsSame(rebuilt, history[nTicks - back]), "rebuilt " + std::to_string(back));
+	}
+	int now = nTicks;
+	for (int back : { 30, 64, 150 })
+	{
+		std::vector<uint64_t> current;
+		check(rewind.StepBack(back, game.state) && (game.state.Snapshot(current), IsSame(current, history[now - back])),
+			"stepped back " + std::to_string(back));
+		now -= back;
+		// carry on from there, the same ticks the history holds
+		for (int t = 0; t < 20; t++)
+		{
+			game.Step(dt);
+			record();
+		}
+		game.state.Snapshot(current);
+		check(IsSame(current, history[now + 20]), "and on again from " + std::to_string(now));
+		now += 20;
+	}
+	check(rewind.GetDepth() == now, "depth " + std::to_string(rewind.GetDepth()));
+	return check.GetExitCode();
+}
@@ -0,0 +1,41 @@
+#include "Headless.h"
+#include <cstdio>
+
+// Runs the same seeded game on a power-of-two torus once with the tick
+// specialised on the board size and once with the generic Topology tick,
+// checks they end in the same state and times both.
+// ShapeTickTest [log2 board size, 6..10] [snakes] [ticks]
+int main(int argc, char* argv[])
+{
+	GameVariables gVar("data.txt");
+	const int logSize = int(Arg(argc, argv, 1, 8));
+	gVar.boardSizeX = gVar.boardSizeY = 1 << logSize;
+	gVar.numSnakes = int(Arg(argc, argv, 2, 2000));
+	const int nTicks = int(Arg(argc, argv, 3, 300));
+	gVar.topology = "torus";
+	gVar.numPlayers = 0;
+	gVar.initialSnakelength = 10;
+	gVar.foodAmount = gVar.numSnakes / 4;
+	const float dt = gVar.initialSpeed;
+
+	std::unique_ptr<Headless> pGames[2];
+	double ms[2];
+	for (int specialised = 1; specialised >= 0; specialised--)
+	{
+		gVar.specialisedBoards = specialised;
+		auto& pGame = pGames[specialised];
+		pGame = std::make_unique<Headless>(gVar, 11);
+		const auto t0 = std::chrono::steady_clock::now();
+		for (int t = 0; t < nTicks; t++)
+		{
+			pGame->Step(dt);
+		}
+		ms[specialised] = MillisecondsSince(t0);
+	}
+	const bool same = pGames[0]->IsSameState(*pGames[1]);
+	printf("%dx%d torus, %d snakes, %d ticks\n", gVar.boardSizeX, gVar.boardSizeY, gVar.numSnakes, nTicks);
+	printf("specialised: %.3f ms/tick, hash %016llx\n", ms[1] / nTicks, (unsigned long long)pGames[1]->GetHash());
+	printf("generic:     %.3f ms/tick, hash %016llx\n", ms[0] / nTicks, (unsigned long long)pGames[0]->GetHash());
+	printf("%s, specialised %.2fx generic\n", same ? "same state" : "STATES DIFFER", ms[0] / ms[1]);
+	return same ? 0 : 1;
+}
@@ -0,0 +1,66 @@
+#include "Headless.h"
+#include <cstdio>
+#include <vector>
+
+// Snapshots a game, runs it on, restores it and runs the same ticks again,
+// which must end in the same state; then clones it into a second game with
+// CopyFrom, which must run on in lockstep, and times the clones.
+// StateCloneTest [ticks] [clones]
+int main(int argc, char* argv[])
+{
+	GameVariables gVar("data.txt");
+	const int nTicks = int(Arg(argc, argv, 1, 500));
+	const int nClones = int(Arg(argc, argv, 2, 2000));
+	gVar.boardSizeX = 256;
+	gVar.boardSizeY = 192;
+	gVar.numPlayers = 0;
+	gVar.numSnakes = 200;
+	gVar.foodAmount = 100;
+	gVar.poisonAmount = 20;
+	gVar.foodLifetime = 4.0f;
+	const float dt = 1.0f / 60.0f;
+	Check check;
+
+	Headless game(gVar, 17);
+	for (int t = 0; t < nTicks; t++)
+	{
+		game.Step(dt);
+	}
+	std::vector<uint64_t> snapshot;
+	game.state.Snapshot(snapshot);
+	for (int t = 0; t < nTicks; t++)
+	{
+		game.Step(dt);
+	}
+	const uint64_t hash = game.GetHash();
+	std::vector<uint64_t> ahead;
+	game.state.Snapshot(ahead);
+	game.state.Restore(snapshot);
+	for (int t = 0; t < nTicks; t++)
+	{
+		game.Step(dt);
+	}
+	std::vector<uint64_t> again;
+	game.state.Snapshot(again);
+	check(game.GetHash() == hash && again == ahead, "restored and rerun ends where the first run did");
+
+	Headless clone(gVar, 18);
+	clone.state.CopyFrom(game.state);
+	check(clone.GetHash() == game.GetHash() && clone.IsSameState(game), "a clone starts out the same");
+	for (int t = 0; t < nTicks; t++)
+	{
+		game.Step(dt);
+		clone.Step(dt);
+	}
+	check(clone.GetHash() == game.GetHash() && clone.IsSameState(game), "and runs on in lockstep");
+
+	const auto t0 = std::chrono::steady_clock::now();
+	for (int k = 0; k < nClones; k++)
+	{
+		clone.state.CopyFrom(game.state);
+	}
+	const double ms = MillisecondsSince(t0);
+	printf("clone of %zu bytes: %.2f us, %.0f clones/s, %.2f GB/s\n", game.state.GetUsed(), 1000.0 * ms / nClones,
+		nClones * 1000.0 / ms, double(game.state.GetUsed()) * nClones / ms / 1e6);
+	return check.GetExitCode();
+}
@@ -0,0 +1,49 @@
+#include "Headless.h"
+#include "AllocationCounter.h"
+#include <cstdio>
+
+// Runs a busy game, snakes crashing and respawning, food expiring, waves and
+// barriers coming and going, on a worker pool with the change journal on,
+// and fails if any tick after the warm-up touches the heap.
+// SteadyStateAllocTest [warm-up ticks] [ticks]
+int main(int argc, char* argv[])
+{
+	GameVariables gVar("data.txt");
+	const int nWarmUp = int(Arg(argc, argv, 1, 3000));
+	const int nTicks = int(Arg(argc, argv, 2, 20000));
+	gVar.boardSizeX = 64;
+	gVar.boardSizeY = 48;
+	gVar.topology = "walls";
+	gVar.numPlayers = 0;
+	gVar.numSnakes = 40;
+	gVar.numThreads = 4;
+	gVar.foodAmount = 40;
+	gVar.poisonAmount = 10;
+	gVar.foodLifetime = 3.0f;
+	gVar.barrierLifetime = 5.0f;
+	gVar.waveInterval = 2.0f;
+	gVar.waveSize = 5;
+	gVar.foodSpawn = "centre";
+	gVar.changeJournal = 1;
+	const float dt = 1.0f / 60.0f;
+
+	Headless game(gVar, 3);
+	for (int t = 0; t < nWarmUp; t++)
+	{
+		game.Step(dt);
+	}
+	const long long foodBefore = game.brd.CountContent(Board::contentType::food);
+	long long nCrashes = 0;
+	AllocationCounter::Arm();
+	for (int t = 0; t < nTicks; t++)
+	{
+		nCrashes += game.Step(dt);
+	}
+	const long long nAllocations = AllocationCounter::Disarm();
+	printf("%d ticks after %d of warm-up: %lld crashes, food %lld -> %lld, %lld allocations\n", nTicks, nWarmUp,
+		nCrashes, foodBefore, game.brd.CountContent(Board::contentType::food), nAllocations);
+	printf("memory pool: %zu bytes used, %zu at peak, %zu reserved\n",
+		game.memory.GetUsed(), game.memory.GetPeak(), game.memory.GetReserved());
+	// without crashes the respawn path would go untested
+	return nAllocations == 0 && nCrashes > 0 ? 0 : 1;
+}
@@ -0,0 +1,55 @@
+#include "Headless.h"
+#include <cstdio>
+
+// Ticks many snakes at pool sizes doubling from 1 up to a maximum and checks
+// that band-parallel planning ends in the same state, byte for byte, as the
+// serial path at every one of them.
+// TickScalingBench [snakes] [ticks] [board size] [most threads]
+int main(int argc, char* argv[])
+{
+	GameVariables gVar("data.txt");
+	gVar.numSnakes = int(Arg(argc, argv, 1, 10000));
+	const int nTicks = int(Arg(argc, argv, 2, 60));
+	gVar.boardSizeX = gVar.boardSizeY = int(Arg(argc, argv, 3, 700));
+	const int maxThreads = int(Arg(argc, argv, 4, 64));
+	gVar.numPlayers = 0;
+	gVar.initialSnakelength = 20;
+	gVar.maxSnakelength = 200;
+	gVar.foodAmount = gVar.numSnakes;
+	// a tick as long as a move, so every snake moves every tick
+	const float dt = gVar.initialSpeed;
+
+	bool ok = true;
+	std::unique_ptr<Headless> pSerial;
+	double serialMs = 0.0;
+	for (int nThreads = 1; nThreads <= maxThreads; nThreads *= 2)
+	{
+		gVar.numThreads = nThreads;
+		auto pGame = std::make_unique<Headless>(gVar, 7);
+		const auto t0 = std::chrono::steady_clock::now();
+		for (int t = 0; t < nTicks; t++)
+		{
+			pGame->Step(dt);
+		}
+		const double ms = MillisecondsSince(t0);
+		bool same = true;
+		if (!pSerial)
+		{
+			serialMs = ms;
+		}
+		else
+		{
+			same = pGame->IsSameState(*pSerial);
+			ok = ok && same;
+		}
+		printf("%d threads: %.3f ms/tick, %.2fx serial, hash %016llx%s\n", nThreads, ms / nTicks, serialMs / ms,
+			(unsigned long long)pGame->GetHash(), same ? "" : "  DIFFERS FROM SERIAL");
+		if (!pSerial)
+		{
+			pSerial = std::move(pGame);
+		}
+	}
+	printf("%d snakes, %d ticks, %dx%d board, %u hardware threads\n", gVar.numSnakes, nTicks,
+		gVar.boardSizeX, gVar.boardSizeY, std::thread::hardware_concurrency());
+	return ok ? 0 : 1;
+}